@@ -0,0 +1,309 @@
+#include <cbor/cbor.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+static std::atomic<size_t> allocation_count{0};
+
+auto operator new(size_t size) -> void* {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if(auto result = malloc(size > 0 ? size : 1)) {
+		return result;
+	}
+	throw std::bad_alloc();
+}
+
+auto operator delete(void* data) noexcept -> void {
+	free(data);
+}
+
+auto operator delete(void* data, size_t) noexcept -> void {
+	free(data);
+}
+
+/// Counts the buffers outputs take from the allocator, they bypass operator new.
+class CountingAllocator : public cbor::MallocAllocator {
+public:
+	auto allocate(size_t size) -> unsigned char* override {
+		allocation_count.fetch_add(1, std::memory_order_relaxed);
+		return cbor::MallocAllocator::allocate(size);
+	}
+	
+	auto reallocate(unsigned char* data, size_t size, size_t used, size_t new_size) -> unsigned char* override {
+		allocation_count.fetch_add(1, std::memory_order_relaxed);
+		return cbor::MallocAllocator::reallocate(data, size, used, new_size);
+	}
+};
+
+struct Corpus {
+	std::string name;
+	std::vector<cbor::PObject> messages;
+	/// Messages are decoded as one CBOR sequence with Decoder::next.
+	bool sequence;
+	
+	Corpus(std::string name, bool sequence = false) :
+		name(std::move(name)), messages(), sequence(sequence) {
+	}
+};
+
+struct Result {
+	std::string corpus;
+	std::string operation;
+	size_t messages;
+	size_t bytes;
+	size_t items;
+	double seconds;
+	double p50_ns;
+	double p99_ns;
+	double allocations;
+};
+
+static auto count_items(cbor::PObject const& value) -> size_t {
+	size_t result = 1;
+	if(value->is_array()) {
+		for(auto const& item: value->as_array()) {
+			result += count_items(item);
+		}
+	} else if(value->is_map()) {
+		for(auto const& p: value->as_map()) {
+			result += 1 + count_items(p.second);
+		}
+	}
+	return result;
+}
+
+static auto make_rpc(std::string name) -> Corpus {
+	Corpus corpus(std::move(name));
+	for(int i = 0; i < 20000; ++i) {
+		auto message = cbor::Object::create_map(0);
+		auto& map_value = message->as<cbor::ObjectType::Map>();
+		map_value["id"] = cbor::Object::from_int(i);
+		map_value["method"] = cbor::Object::from_string(i % 3 == 0 ? "get" : "subscribe");
+		auto params = cbor::Object::create_array(0);
+		params->as<cbor::ObjectType::Array>().push_back(cbor::Object::from_int(i * 31));
+		params->as<cbor::ObjectType::Array>().push_back(cbor::Object::from_string("user-" + std::to_string(i % 97)));
+		map_value["params"] = params;
+		map_value["ok"] = cbor::Object::from_bool(i % 5 != 0);
+		corpus.messages.push_back(message);
+	}
+	return corpus;
+}
+
+static auto make_wide_map(std::string name) -> Corpus {
+	Corpus corpus(std::move(name));
+	for(int i = 0; i < 50; ++i) {
+		auto message = cbor::Object::create_map(0);
+		auto& map_value = message->as<cbor::ObjectType::Map>();
+		for(int j = 0; j < 2000; ++j) {
+			map_value["field_" + std::to_string(j)] = cbor::Object::from_string(std::string(j % 24, 'v'));
+		}
+		corpus.messages.push_back(message);
+	}
+	return corpus;
+}
+
+static auto make_deep(std::string name) -> Corpus {
+	Corpus corpus(std::move(name));
+	for(int i = 0; i < 500; ++i) {
+		auto message = cbor::Object::create_array(0);
+		auto node = message;
+		for(int depth = 0; depth < 200; ++depth) {
+			auto child = cbor::Object::create_array(0);
+			node->as<cbor::ObjectType::Array>().push_back(cbor::Object::from_int(depth));
+			node->as<cbor::ObjectType::Array>().push_back(child);
+			node = child;
+		}
+		corpus.messages.push_back(message);
+	}
+	return corpus;
+}
+
+static auto make_blobs(std::string name) -> Corpus {
+	Corpus corpus(std::move(name));
+	for(int i = 0; i < 50; ++i) {
+		auto message = cbor::Object::create_array(0);
+		message->as<cbor::ObjectType::Array>().push_back(cbor::Object::from_string("blob-" + std::to_string(i)));
+		message->as<cbor::ObjectType::Array>().push_back(cbor::Object::from_bytes(cbor::BytesValue(1 << 20, (char)i)));
+		corpus.messages.push_back(message);
+	}
+	return corpus;
+}
+
+static auto make_int_array(std::string name) -> Corpus {
+	Corpus corpus(std::move(name));
+	uint64_t state = 88172645463325252ULL;
+	for(int i = 0; i < 50; ++i) {
+		auto message = cbor::Object::create_array(0);
+		auto& array_value = message->as<cbor::ObjectType::Array>();
+		for(int j = 0; j < 20000; ++j) {
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			// mix of 1, 2, 3 and 5 byte encodings, some negative
+			int64_t value = (int64_t)(state >> (64 - 8 * (1 + j % 4)));
+			array_value.push_back(cbor::Object::from_int(j % 7 == 0 ? -value : value));
+		}
+		corpus.messages.push_back(message);
+	}
+	return corpus;
+}
+
+static auto make_sequence(std::string name) -> Corpus {
+	Corpus corpus(std::move(name), true);
+	for(int i = 0; i < 100000; ++i) {
+		auto message = cbor::Object::create_array(0);
+		message->as<cbor::ObjectType::Array>().push_back(cbor::Object::from_int(i));
+		message->as<cbor::ObjectType::Array>().push_back(cbor::Object::from_string("event"));
+		corpus.messages.push_back(message);
+	}
+	return corpus;
+}
+
+static auto percentile(std::vector<double>& values, double fraction) -> double {
+	if(values.empty()) {
+		return 0;
+	}
+	auto index = std::min(values.size() - 1, (size_t)(fraction * (double)values.size()));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+using Clock = std::chrono::steady_clock;
+
+static auto elapsed_ns(Clock::time_point begin, Clock::time_point end) -> double {
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+}
+
+static auto bench_encode(Corpus const& corpus, size_t rounds, size_t items) -> Result {
+	CountingAllocator allocator;
+	cbor::OutputDynamic output(allocator);
+	std::vector<double> latencies;
+	latencies.reserve(corpus.messages.size() * rounds);
+	size_t bytes = 0;
+	size_t allocations = 0;
+	double total = 0;
+	for(size_t round = 0; round < rounds; ++round) {
+		for(auto const& message: corpus.messages) {
+			output.reset();
+			auto allocations_before = allocation_count.load();
+			auto begin = Clock::now();
+			cbor::Encoder(output).write_object(message);
+			auto end = Clock::now();
+			allocations += allocation_count.load() - allocations_before;
+			latencies.push_back(elapsed_ns(begin, end));
+			total += latencies.back();
+			bytes += output.size();
+		}
+	}
+	auto messages = corpus.messages.size() * rounds;
+	return {
+		corpus.name, "encode", messages, bytes, items * rounds, total / 1e9,
+		percentile(latencies, 0.5), percentile(latencies, 0.99), (double)allocations / (double)messages
+	};
+}
+
+static auto bench_decode(Corpus const& corpus, size_t rounds, size_t items) -> Result {
+	std::vector<std::vector<unsigned char> > encoded;
+	cbor::OutputDynamic output;
+	for(auto const& message: corpus.messages) {
+		output.reset();
+		cbor::Encoder(output).write_object(message);
+		encoded.push_back(output.bytes());
+	}
+	std::vector<unsigned char> joined;
+	for(auto const& message: encoded) {
+		joined.insert(joined.end(), message.begin(), message.end());
+	}
+	
+	std::vector<double> latencies;
+	latencies.reserve(corpus.messages.size() * rounds);
+	size_t allocations = 0;
+	double total = 0;
+	for(size_t round = 0; round < rounds; ++round) {
+		if(corpus.sequence) {
+			cbor::Input input(joined.data(), (int)joined.size());
+			cbor::Decoder decoder(input);
+			while(true) {
+				auto allocations_before = allocation_count.load();
+				auto begin = Clock::now();
+				auto item = decoder.next();
+				auto end = Clock::now();
+				if(!item) {
+					break;
+				}
+				allocations += allocation_count.load() - allocations_before;
+				latencies.push_back(elapsed_ns(begin, end));
+				total += latencies.back();
+			}
+		} else {
+			for(auto& message: encoded) {
+				auto allocations_before = allocation_count.load();
+				auto begin = Clock::now();
+				cbor::Input input(message.data(), (int)message.size());
+				auto result = cbor::Decoder(input).run();
+				auto end = Clock::now();
+				allocations += allocation_count.load() - allocations_before;
+				latencies.push_back(elapsed_ns(begin, end));
+				total += latencies.back();
+			}
+		}
+	}
+	auto messages = corpus.messages.size() * rounds;
+	return {
+		corpus.name, "decode", messages, joined.size() * rounds, items * rounds, total / 1e9,
+		percentile(latencies, 0.5), percentile(latencies, 0.99), (double)allocations / (double)messages
+	};
+}
+
+static auto print_json(std::vector<Result> const& results) -> void {
+	printf("{\n\t\"results\": [\n");
+	for(size_t i = 0; i < results.size(); ++i) {
+		auto const& result = results[i];
+		printf(
+			"\t\t{\"corpus\": \"%s\", \"operation\": \"%s\", \"messages\": %zu, \"bytes\": %zu, \"items\": %zu, "
+			"\"mb_per_s\": %.2f, \"items_per_s\": %.0f, \"p50_ns\": %.0f, \"p99_ns\": %.0f, \"allocations_per_message\": %.2f}%s\n",
+			result.corpus.c_str(), result.operation.c_str(), result.messages, result.bytes, result.items,
+			(double)result.bytes / 1e6 / result.seconds, (double)result.items / result.seconds,
+			result.p50_ns, result.p99_ns, result.allocations, i + 1 < results.size() ? "," : ""
+		);
+	}
+	printf("\t]\n}\n");
+}
+
+/// Usage: cbor_cpp_bench [rounds] [corpus]
+int main(int argc, char** argv) {
+	size_t rounds = argc > 1 ? (size_t)std::max(1, atoi(argv[1])) : 3;
+	std::string filter = argc > 2 ? argv[2] : "";
+	
+	std::vector<std::pair<std::string, std::function<Corpus(std::string)> > > makers = {
+		{"rpc", make_rpc},
+		{"wide_map", make_wide_map},
+		{"deep", make_deep},
+		{"blobs", make_blobs},
+		{"int_array", make_int_array},
+		{"sequence", make_sequence},
+	};
+	std::vector<Result> results;
+	for(auto const& [name, make]: makers) {
+		// filtered before building, some corpora take a while to generate
+		if(!filter.empty() && name != filter) {
+			continue;
+		}
+		auto corpus = make(name);
+		size_t items = 0;
+		for(auto const& message: corpus.messages) {
+			items += count_items(message);
+		}
+		results.push_back(bench_encode(corpus, rounds, items));
+		results.push_back(bench_decode(corpus, rounds, items));
+	}
+	print_json(results);
+	return 0;
+}
@@ -0,0 +1,147 @@
+#include "Allocator.hpp"
+#include "../Exceptions/Exceptions.hpp"
+
+#include <string.h>
+#include <stdlib.h>
+#include <new>
+#include <utility>
+
+namespace cbor {
+	auto Allocator::reallocate(unsigned char* data, size_t size, size_t used, size_t new_size) -> unsigned char* {
+		auto result = allocate(new_size);
+		memcpy(result, data, used);
+		deallocate(data, size);
+		return result;
+	}
+	
+	auto Allocator::standard() -> Allocator& {
+		static MallocAllocator allocator;
+		return allocator;
+	}
+	
+	auto Allocator::thread_pool() -> Allocator& {
+		static ThreadPoolAllocator allocator;
+		return allocator;
+	}
+	
+	static auto local_pool() -> PoolAllocator& {
+		thread_local PoolAllocator pool;
+		return pool;
+	}
+	
+	auto MallocAllocator::allocate(size_t size) -> unsigned char* {
+		auto result = (unsigned char*)malloc(size);
+		if(result == nullptr) {
+			throw_exception(std::bad_alloc());
+		}
+		return result;
+	}
+	
+	auto MallocAllocator::deallocate(unsigned char* data, size_t) -> void {
+		free(data);
+	}
+	
+	auto MallocAllocator::reallocate(unsigned char* data, size_t, size_t, size_t new_size) -> unsigned char* {
+		auto result = (unsigned char*)realloc(data, new_size);
+		if(result == nullptr) {
+			throw_exception(std::bad_alloc());
+		}
+		return result;
+	}
+	
+	PoolAllocator::PoolAllocator(Allocator& upstream) :
+		_upstream(&upstream), _cached(), _cached_count() {
+	}
+	
+	auto PoolAllocator::size_class(size_t size) -> size_t {
+		if(size < 64 || (size & (size - 1)) != 0) {
+			return class_count;
+		}
+		size_t result = 0;
+		while(((size_t)64 << result) < size) {
+			++result;
+		}
+		return result;
+	}
+	
+	auto PoolAllocator::allocate(size_t size) -> unsigned char* {
+		auto index = size_class(size);
+		if(index < class_count && _cached_count[index] > 0) {
+			return _cached[index][--_cached_count[index]];
+		}
+		return _upstream->allocate(size);
+	}
+	
+	auto PoolAllocator::deallocate(unsigned char* data, size_t size) -> void {
+		auto index = size_class(size);
+		if(index < class_count && _cached_count[index] < max_cached) {
+			_cached[index][_cached_count[index]++] = data;
+		} else {
+			_upstream->deallocate(data, size);
+		}
+	}
+	
+	auto PoolAllocator::trim() -> void {
+		for(size_t index = 0; index < class_count; ++index) {
+			while(_cached_count[index] > 0) {
+				_upstream->deallocate(_cached[index][--_cached_count[index]], (size_t)64 << index);
+			}
+		}
+	}
+	
+	PoolAllocator::~PoolAllocator() {
+		trim();
+	}
+	
+	auto ThreadPoolAllocator::allocate(size_t size) -> unsigned char* {
+		return local_pool().allocate(size);
+	}
+	
+	auto ThreadPoolAllocator::deallocate(unsigned char* data, size_t size) -> void {
+		local_pool().deallocate(data, size);
+	}
+	
+	Buffer::Buffer() :
+		_data(nullptr), _size(0), _capacity(0), _allocator(nullptr) {
+	}
+	
+	Buffer::Buffer(unsigned char* data, size_t size, size_t capacity, Allocator& allocator) :
+		_data(data), _size(size), _capacity(capacity), _allocator(&allocator) {
+	}
+	
+	Buffer::Buffer(Buffer&& other) noexcept :
+		_data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0)),
+		_capacity(std::exchange(other._capacity, 0)), _allocator(other._allocator) {
+	}
+	
+	auto Buffer::operator=(Buffer&& other) noexcept -> Buffer& {
+		if(this != &other) {
+			if(_data != nullptr) {
+				_allocator->deallocate(_data, _capacity);
+			}
+			_data = std::exchange(other._data, nullptr);
+			_size = std::exchange(other._size, 0);
+			_capacity = std::exchange(other._capacity, 0);
+			_allocator = other._allocator;
+		}
+		return *this;
+	}
+	
+	auto Buffer::data() const -> unsigned char* {
+		return _data;
+	}
+	
+	auto Buffer::size() const -> size_t {
+		return _size;
+	}
+	
+	auto Buffer::capacity() const -> size_t {
+		return _capacity;
+	}
+	
+	Buffer::~Buffer() {
+		if(_data != nullptr) {
+			_allocator->deallocate(_data, _capacity);
+		}
+	}
+}
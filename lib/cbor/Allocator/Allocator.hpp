@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cbor {
+	/// Source of the heap buffers used by dynamic outputs.
+	class Allocator {
+	public:
+		virtual auto allocate(size_t size) -> unsigned char* = 0;
+		
+		virtual auto deallocate(unsigned char* data, size_t size) -> void = 0;
+		
+		/// Moves the first used bytes of data into a buffer of new_size bytes.
+		virtual auto reallocate(unsigned char* data, size_t size, size_t used, size_t new_size) -> unsigned char*;
+		
+		virtual ~Allocator() = default;
+		
+		/// Process-wide allocator backed by malloc and realloc.
+		static auto standard() -> Allocator&;
+		
+		/// Keeps freed power-of-two buffers in a pool of the calling thread, buffers may be freed on any thread.
+		static auto thread_pool() -> Allocator&;
+	};
+	
+	class MallocAllocator : public Allocator {
+	public:
+		auto allocate(size_t size) -> unsigned char* override;
+		
+		auto deallocate(unsigned char* data, size_t size) -> void override;
+		
+		auto reallocate(unsigned char* data, size_t size, size_t used, size_t new_size) -> unsigned char* override;
+	};
+	
+	/// Caches up to max_cached freed buffers per power-of-two size class from 64 bytes to 1 MiB, not thread safe.
+	class PoolAllocator : public Allocator {
+	public:
+		static constexpr size_t class_count = 15;
+		
+		static constexpr size_t max_cached = 8;
+		
+		PoolAllocator(Allocator& upstream = Allocator::standard());
+		
+		PoolAllocator(PoolAllocator const&) = delete;
+		
+		auto operator=(PoolAllocator const&) -> PoolAllocator& = delete;
+		
+		auto allocate(size_t size) -> unsigned char* override;
+		
+		auto deallocate(unsigned char* data, size_t size) -> void override;
+		
+		auto trim() -> void;
+		
+		~PoolAllocator();
+	
+	private:
+		static auto size_class(size_t size) -> size_t;
+		
+		Allocator* _upstream;
+		unsigned char* _cached[class_count][max_cached];
+		size_t _cached_count[class_count];
+	};
+	
+	class ThreadPoolAllocator : public Allocator {
+	public:
+		auto allocate(size_t size) -> unsigned char* override;
+		
+		auto deallocate(unsigned char* data, size_t size) -> void override;
+	};
+	
+	/// Heap buffer owned together with the allocator that has to free it.
+	class Buffer {
+	public:
+		Buffer();
+		
+		Buffer(unsigned char* data, size_t size, size_t capacity, Allocator& allocator);
+		
+		Buffer(Buffer&& other) noexcept;
+		
+		Buffer(Buffer const&) = delete;
+		
+		auto operator=(Buffer&& other) noexcept -> Buffer&;
+		
+		auto operator=(Buffer const&) -> Buffer& = delete;
+		
+		auto data() const -> unsigned char*;
+		
+		auto size() const -> size_t;
+		
+		auto capacity() const -> size_t;
+		
+		~Buffer();
+	
+	private:
+		unsigned char* _data;
+		size_t _size;
+		size_t _capacity;
+		Allocator* _allocator;
+	};
+}
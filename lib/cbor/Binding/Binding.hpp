@@ -0,0 +1,54 @@
+#pragma once
+
+#include <tuple>
+#include <string_view>
+#include <type_traits>
+#include <cstdint>
+
+namespace cbor {
+	constexpr auto key_hash(std::string_view key) -> uint64_t {
+		uint64_t hash = 14695981039346656037ULL;
+		for(auto c: key) {
+			hash ^= (uint8_t)c;
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+	
+	template<typename Class_, typename Member_>
+	struct Field {
+		using Class = Class_;
+		using Member = Member_;
+		
+		std::string_view name;
+		Member_ Class_::* member;
+	};
+	
+	template<typename Class_, typename Member_>
+	constexpr auto field(std::string_view name, Member_ Class_::* member) -> Field<Class_, Member_> {
+		return {name, member};
+	}
+	
+	/// Describes how a user type maps to a CBOR map, shared by cbor::encode and cbor::decode.
+	///
+	/// template<>
+	/// struct cbor::Binding<Point> {
+	/// 	static constexpr auto fields = std::make_tuple(cbor::field("x", &Point::x), cbor::field("y", &Point::y));
+	/// };
+	template<typename T>
+	struct Binding;
+	
+	template<typename T, typename = void>
+	struct IsBound : std::false_type {
+	};
+	
+	template<typename T>
+	struct IsBound<T, std::void_t<decltype(Binding<T>::fields)> > : std::true_type {
+	};
+	
+	template<typename T>
+	constexpr auto is_bound = IsBound<T>::value;
+	
+	template<typename T>
+	constexpr auto field_count = std::tuple_size_v<std::decay_t<decltype(Binding<T>::fields)> >;
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include "../Binding/Binding.hpp"
+#include "../TagHandler/TagHandler.hpp"
+#include "../Reader/Reader.hpp"
+#include "../Encoder/Encoder.hpp"
+#include "../Exceptions/Exceptions.hpp"
+#include <optional>
+#include <variant>
+#include <vector>
+#include <unordered_map>
+#include <limits>
+
+namespace cbor {
+	/// Encodes and decodes T directly, without building Object trees.
+	template<typename T, typename = void>
+	struct Codec;
+	
+	template<>
+	struct Codec<bool> {
+		static auto accepts(Head const& head) -> bool {
+			return head.is_bool();
+		}
+		
+		static auto encode(Encoder& encoder, bool value) -> void {
+			encoder.write_bool(value);
+		}
+		
+		static auto decode(Reader&, Head const& head, bool& value) -> void {
+			if(!head.is_bool()) {
+				throw_exception(DecodeException("expected bool"));
+			}
+			value = head.minor_type == 21;
+		}
+	};
+	
+	template<typename T>
+	struct Codec<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && !is_tag_handled<T> > > {
+		static auto accepts(Head const& head) -> bool {
+			return head.major_type == 0 || head.major_type == 1;
+		}
+		
+		static auto encode(Encoder& encoder, T value) -> void {
+			if constexpr(std::is_signed_v<T>) {
+				encoder.write_int((int64_t)value);
+			} else {
+				encoder.write_int((uint64_t)value);
+			}
+		}
+		
+		static auto decode(Reader&, Head const& head, T& value) -> void {
+			if(!accepts(head)) {
+				throw_exception(DecodeException("expected integer"));
+			}
+			if(head.value > (uint64_t)std::numeric_limits<T>::max()) {
+				throw_exception(DecodeException("integer out of range"));
+			}
+			if(head.major_type == 0) {
+				value = (T)head.value;
+			} else if constexpr(std::is_signed_v<T>) {
+				value = (T)(-1 - (int64_t)head.value);
+			} else {
+				throw_exception(DecodeException("integer out of range"));
+			}
+		}
+	};
+	
+	template<>
+	struct Codec<std::string> {
+		static auto accepts(Head const& head) -> bool {
+			return head.major_type == 3;
+		}
+		
+		static auto encode(Encoder& encoder, std::string const& value) -> void {
+			encoder.write_string(value.data(), (uint32_t)value.size());
+		}
+		
+		static auto decode(Reader& reader, Head const& head, std::string& value) -> void {
+			if(!accepts(head)) {
+				throw_exception(DecodeException("expected string"));
+			}
+			reader.read_string(head, value);
+		}
+	};
+	
+	template<>
+	struct Codec<std::vector<char> > {
+		static auto accepts(Head const& head) -> bool {
+			return head.major_type == 2;
+		}
+		
+		static auto encode(Encoder& encoder, std::vector<char> const& value) -> void {
+			encoder.write_bytes((const uint8_t*)value.data(), (uint32_t)value.size());
+		}
+		
+		static auto decode(Reader& reader, Head const& head, std::vector<char>& value) -> void {
+			if(!accepts(head)) {
+				throw_exception(DecodeException("expected bytes"));
+			}
+			reader.require(head.value);
+			value.resize(head.value);
+			reader.read_bytes(head, value.data());
+		}
+	};
+	
+	template<typename T>
+	struct Codec<std::vector<T> > {
+		static auto accepts(Head const& head) -> bool {
+			return head.major_type == 4;
+		}
+		
+		static auto encode(Encoder& encoder, std::vector<T> const& value) -> void {
+			encoder.write_array((int)value.size());
+			for(auto const& item: value) {
+				Codec<T>::encode(encoder, item);
+			}
+		}
+		
+		static auto decode(Reader& reader, Head const& head, std::vector<T>& value) -> void {
+			if(!accepts(head)) {
+				throw_exception(DecodeException("expected array"));
+			}
+			value.clear();
+			value.reserve(reader.reserve_limit(head.value));
+			for(uint64_t i = 0; i < head.value; ++i) {
+				Codec<T>::decode(reader, reader.read_head(), value.emplace_back());
+			}
+		}
+	};
+	
+	template<typename T>
+	struct Codec<std::optional<T> > {
+		static auto accepts(Head const& head) -> bool {
+			return head.is_null() || head.is_undefined() || Codec<T>::accepts(head);
+		}
+		
+		static auto encode(Encoder& encoder, std::optional<T> const& value) -> void {
+			if(value) {
+				Codec<T>::encode(encoder, *value);
+			} else {
+				encoder.write_null();
+			}
+		}
+		
+		static auto decode(Reader& reader, Head const& head, std::optional<T>& value) -> void {
+			if(head.is_null() || head.is_undefined()) {
+				value.reset();
+			} else {
+				Codec<T>::decode(reader, head, value.emplace());
+			}
+		}
+	};
+	
+	template<typename... Ts>
+	struct Codec<std::variant<Ts...> > {
+		static auto accepts(Head const& head) -> bool {
+			return (Codec<Ts>::accepts(head) || ...);
+		}
+		
+		static auto encode(Encoder& encoder, std::variant<Ts...> const& value) -> void {
+			std::visit([&](auto const& alternative) {
+				Codec<std::decay_t<decltype(alternative)> >::encode(encoder, alternative);
+			}, value);
+		}
+		
+		static auto decode(Reader& reader, Head const& head, std::variant<Ts...>& value) -> void {
+			if(!decode_alternative(reader, head, value, std::index_sequence_for<Ts...>{})) {
+				throw_exception(DecodeException("no matching variant alternative"));
+			}
+		}
+	
+	private:
+		template<size_t... Is>
+		static auto decode_alternative(Reader& reader, Head const& head, std::variant<Ts...>& value, std::index_sequence<Is...>) -> bool {
+			return ((Codec<Ts>::accepts(head) && (Codec<Ts>::decode(reader, head, value.template emplace<Is>()), true)) || ...);
+		}
+	};
+	
+	template<typename T>
+	struct Codec<std::unordered_map<std::string, T> > {
+		static auto accepts(Head const& head) -> bool {
+			return head.major_type == 5;
+		}
+		
+		static auto encode(Encoder& encoder, std::unordered_map<std::string, T> const& value) -> void {
+			encoder.write_map((int)value.size());
+			for(auto const& [key, item]: value) {
+				encoder.write_string(key.data(), (uint32_t)key.size());
+				Codec<T>::encode(encoder, item);
+			}
+		}
+		
+		static auto decode(Reader& reader, Head const& head, std::unordered_map<std::string, T>& value) -> void {
+			if(!accepts(head)) {
+				throw_exception(DecodeException("expected map"));
+			}
+			value.clear();
+			value.reserve(reader.reserve_limit(head.value));
+			std::string key;
+			for(uint64_t i = 0; i < head.value; ++i) {
+				auto key_head = reader.read_head();
+				if(key_head.major_type != 3) {
+					throw_exception(DecodeException("invalid map key type"));
+				}
+				reader.read_string(key_head, key);
+				Codec<T>::decode(reader, reader.read_head(), value[key]);
+			}
+		}
+	};
+	
+	template<typename T>
+	struct Codec<T, std::enable_if_t<is_tag_handled<T> > > {
+		static auto accepts(Head const& head) -> bool {
+			return head.major_type == 6 && TagHandler<T>::handles(head.value);
+		}
+		
+		static auto encode(Encoder& encoder, T const& value) -> void {
+			TagHandler<T>::encode(encoder, value);
+		}
+		
+		static auto decode(Reader& reader, Head const& head, T& value) -> void {
+			if(!accepts(head)) {
+				throw_exception(DecodeException("expected tag"));
+			}
+			TagHandler<T>::decode(reader, head.value, value);
+		}
+	};
+	
+	template<typename T>
+	struct Codec<T, std::enable_if_t<is_bound<T> > > {
+		static auto accepts(Head const& head) -> bool {
+			return head.major_type == 5;
+		}
+		
+		static auto encode(Encoder& encoder, T const& value) -> void;
+		
+		static auto decode(Reader& reader, Head const& head, T& value) -> void;
+	};
+	
+	template<typename T>
+	auto encode(Encoder& encoder, T const& value) -> void;
+	
+	template<typename T>
+	auto encode(Output& out, T const& value) -> void;
+	
+	template<typename T>
+	auto decode(Reader& reader, T& value) -> void;
+	
+	template<typename T>
+	auto decode(Input& in, T& value) -> void;
+	
+	template<typename T>
+	auto decode(Input& in) -> T;
+}
+
+#include "Codec.inl"
@@ -0,0 +1,157 @@
+//included into Codec.hpp
+
+#include <array>
+
+namespace cbor {
+	constexpr auto field_slot(uint64_t hash, uint64_t seed, uint32_t bits) -> size_t {
+		return (size_t)(((hash ^ seed) * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+	}
+	
+	struct FieldLayout {
+		uint64_t seed;
+		uint32_t bits;
+		bool found;
+	};
+	
+	template<size_t Count_>
+	constexpr auto find_field_layout(std::array<uint64_t, Count_> const& hashes) -> FieldLayout {
+		uint32_t min_bits = 1;
+		while(((size_t)1 << min_bits) < Count_) {
+			++min_bits;
+		}
+		for(uint32_t bits = min_bits + 1; bits <= min_bits + 8; ++bits) {
+			for(uint64_t seed = 0; seed < 64; ++seed) {
+				bool unique = true;
+				for(size_t i = 0; i < Count_ && unique; ++i) {
+					for(size_t j = i + 1; j < Count_ && unique; ++j) {
+						unique = field_slot(hashes[i], seed, bits) != field_slot(hashes[j], seed, bits);
+					}
+				}
+				if(unique) {
+					return {seed, bits, true};
+				}
+			}
+		}
+		return {0, 1, false};
+	}
+	
+	template<typename T, size_t I>
+	auto decode_bound_field(Reader& reader, T& value) -> void {
+		auto const& field = std::get<I>(Binding<T>::fields);
+		using Member = typename std::decay_t<decltype(field)>::Member;
+		Codec<Member>::decode(reader, reader.read_head(), value.*field.member);
+	}
+	
+	template<typename T, size_t... Is>
+	constexpr auto make_field_names(std::index_sequence<Is...>) -> std::array<std::string_view, sizeof...(Is)> {
+		return {std::get<Is>(Binding<T>::fields).name...};
+	}
+	
+	template<typename T, size_t... Is>
+	constexpr auto make_field_hashes(std::index_sequence<Is...>) -> std::array<uint64_t, sizeof...(Is)> {
+		return {key_hash(std::get<Is>(Binding<T>::fields).name)...};
+	}
+	
+	template<typename T, size_t... Is>
+	constexpr auto make_field_decoders(std::index_sequence<Is...>) -> std::array<void (*)(Reader&, T&), sizeof...(Is)> {
+		return {&decode_bound_field<T, Is>...};
+	}
+	
+	template<size_t Bits_, size_t Count_>
+	constexpr auto make_field_slots(std::array<uint64_t, Count_> const& hashes, uint64_t seed) -> std::array<int32_t, (size_t)1 << Bits_> {
+		std::array<int32_t, (size_t)1 << Bits_> result{};
+		for(auto& slot: result) {
+			slot = -1;
+		}
+		for(size_t i = 0; i < Count_; ++i) {
+			result[field_slot(hashes[i], seed, Bits_)] = (int32_t)i;
+		}
+		return result;
+	}
+	
+	/// Compile-time perfect hash from the key of every bound field to its index.
+	template<typename T>
+	struct FieldTable {
+		static constexpr auto names = make_field_names<T>(std::make_index_sequence<field_count<T> >{});
+		
+		static constexpr auto hashes = make_field_hashes<T>(std::make_index_sequence<field_count<T> >{});
+		
+		static constexpr auto decoders = make_field_decoders<T>(std::make_index_sequence<field_count<T> >{});
+		
+		static constexpr auto layout = find_field_layout(hashes);
+		
+		static_assert(layout.found, "cbor::Binding has duplicate field names");
+		
+		static constexpr auto slots = make_field_slots<layout.bits>(hashes, layout.seed);
+		
+		static auto find(std::string_view key) -> int32_t {
+			auto hash = key_hash(key);
+			auto index = slots[field_slot(hash, layout.seed, layout.bits)];
+			if(index >= 0 && hashes[index] == hash && names[index] == key) {
+				return index;
+			}
+			return -1;
+		}
+	};
+	
+	template<typename T>
+	auto Codec<T, std::enable_if_t<is_bound<T> > >::encode(Encoder& encoder, T const& value) -> void {
+		encoder.write_map((int)field_count<T>);
+		std::apply([&](auto const&... fields) {
+			((
+				encoder.write_string(fields.name.data(), (uint32_t)fields.name.size()),
+				Codec<typename std::decay_t<decltype(fields)>::Member>::encode(encoder, value.*fields.member)
+			), ...);
+		}, Binding<T>::fields);
+	}
+	
+	template<typename T>
+	auto Codec<T, std::enable_if_t<is_bound<T> > >::decode(Reader& reader, Head const& head, T& value) -> void {
+		if(!accepts(head)) {
+			throw_exception(DecodeException("expected map"));
+		}
+		std::string key;
+		for(uint64_t i = 0; i < head.value; ++i) {
+			auto key_head = reader.read_head();
+			if(key_head.major_type != 3) {
+				throw_exception(DecodeException("invalid map key type"));
+			}
+			reader.read_string(key_head, key);
+			auto index = FieldTable<T>::find(key);
+			if(index >= 0) {
+				FieldTable<T>::decoders[index](reader, value);
+			} else {
+				reader.skip();
+			}
+		}
+	}
+	
+	template<typename T>
+	auto encode(Encoder& encoder, T const& value) -> void {
+		Codec<T>::encode(encoder, value);
+	}
+	
+	template<typename T>
+	auto encode(Output& out, T const& value) -> void {
+		Encoder encoder(out);
+		Codec<T>::encode(encoder, value);
+	}
+	
+	template<typename T>
+	auto decode(Reader& reader, T& value) -> void {
+		Codec<T>::decode(reader, reader.read_head(), value);
+	}
+	
+	template<typename T>
+	auto decode(Input& in, T& value) -> void {
+		Reader reader(in);
+		Codec<T>::decode(reader, reader.read_head(), value);
+	}
+	
+	template<typename T>
+	auto decode(Input& in) -> T {
+		T value{};
+		decode(in, value);
+		return value;
+	}
+}
@@ -0,0 +1,84 @@
+#include "Crc32c.hpp"
+
+#include <string.h>
+#include <array>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define CBOR_CRC32C_SSE42
+#endif
+
+namespace cbor {
+	using Crc32cTables = std::array<std::array<uint32_t, 256>, 8>;
+	
+	static constexpr auto make_crc32c_tables() -> Crc32cTables {
+		Crc32cTables tables{};
+		for(uint32_t i = 0; i < 256; ++i) {
+			uint32_t crc = i;
+			for(int bit = 0; bit < 8; ++bit) {
+				crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+			}
+			tables[0][i] = crc;
+		}
+		for(uint32_t i = 0; i < 256; ++i) {
+			for(size_t table = 1; table < 8; ++table) {
+				tables[table][i] = (tables[table - 1][i] >> 8) ^ tables[0][tables[table - 1][i] & 0xff];
+			}
+		}
+		return tables;
+	}
+	
+	static constexpr auto crc32c_tables = make_crc32c_tables();
+	
+	static auto crc32c_software(uint32_t crc, const uint8_t* data, size_t size) -> uint32_t {
+		while(size >= 8) {
+			uint32_t low;
+			uint32_t high;
+			memcpy(&low, data, 4);
+			memcpy(&high, data + 4, 4);
+			low ^= crc;
+			crc =
+				crc32c_tables[7][low & 0xff] ^ crc32c_tables[6][(low >> 8) & 0xff] ^
+				crc32c_tables[5][(low >> 16) & 0xff] ^ crc32c_tables[4][low >> 24] ^
+				crc32c_tables[3][high & 0xff] ^ crc32c_tables[2][(high >> 8) & 0xff] ^
+				crc32c_tables[1][(high >> 16) & 0xff] ^ crc32c_tables[0][high >> 24];
+			data += 8;
+			size -= 8;
+		}
+		while(size-- > 0) {
+			crc = (crc >> 8) ^ crc32c_tables[0][(crc ^ *data++) & 0xff];
+		}
+		return crc;
+	}
+
+#ifdef CBOR_CRC32C_SSE42
+	__attribute__((target("sse4.2")))
+	static auto crc32c_hardware(uint32_t crc, const uint8_t* data, size_t size) -> uint32_t {
+		uint64_t crc64 = crc;
+		while(size >= 8) {
+			uint64_t value;
+			memcpy(&value, data, 8);
+			crc64 = _mm_crc32_u64(crc64, value);
+			data += 8;
+			size -= 8;
+		}
+		auto crc32 = (uint32_t)crc64;
+		while(size-- > 0) {
+			crc32 = _mm_crc32_u8(crc32, *data++);
+		}
+		return crc32;
+	}
+	
+	static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+#endif
+	
+	auto crc32c(uint32_t crc, const void* data, size_t size) -> uint32_t {
+		crc = ~crc;
+#ifdef CBOR_CRC32C_SSE42
+		if(has_sse42) {
+			return ~crc32c_hardware(crc, (const uint8_t*)data, size);
+		}
+#endif
+		return ~crc32c_software(crc, (const uint8_t*)data, size);
+	}
+}
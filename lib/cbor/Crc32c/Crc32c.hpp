@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace cbor {
+	/// Continues a CRC32C (Castagnoli) over data, start with crc = 0.
+	/// Uses the SSE4.2 crc32 instruction when the CPU has it and slicing-by-8 tables otherwise.
+	auto crc32c(uint32_t crc, const void* data, size_t size) -> uint32_t;
+}
@@ -0,0 +1,70 @@
+#include "DecodeLimits.hpp"
+#include "../Object/Object.hpp"
+
+namespace cbor {
+	// the same estimates as Object::memory_usage
+	static constexpr uint64_t node_bytes = sizeof(Object) + 2 * sizeof(void*);
+	static constexpr uint64_t array_slot_bytes = sizeof(PObject);
+	static constexpr uint64_t map_entry_bytes = 4 * sizeof(void*) + sizeof(MapValue::value_type);
+	
+	DecodeBudget::DecodeBudget(DecodeLimits const& limits) :
+		_limits(limits), _bytes(0), _items(0), _announced(0) {
+	}
+	
+	auto DecodeBudget::limits() const -> DecodeLimits const& {
+		return _limits;
+	}
+	
+	auto DecodeBudget::reset() -> void {
+		_bytes = 0;
+		_items = 0;
+		_announced = 0;
+	}
+	
+	auto DecodeBudget::charge(uint64_t bytes) -> bool {
+		if(bytes > _limits.max_bytes - _bytes) {
+			return false;
+		}
+		_bytes += bytes;
+		return true;
+	}
+	
+	auto DecodeBudget::item() -> bool {
+		if(_announced > 0) {
+			--_announced;
+		} else {
+			if(_items >= _limits.max_items) {
+				return false;
+			}
+			++_items;
+		}
+		return charge(node_bytes);
+	}
+	
+	auto DecodeBudget::payload(uint64_t length) -> bool {
+		return length <= _limits.max_string_length && charge(length);
+	}
+	
+	auto DecodeBudget::container(uint64_t count, bool is_map) -> bool {
+		// keys are items of their own, like in Decoder
+		auto items = is_map ? count * 2 : count;
+		if(items > _limits.max_items - _items) {
+			return false;
+		}
+		_items += items;
+		_announced += items;
+		return charge((is_map ? map_entry_bytes : array_slot_bytes) * count);
+	}
+	
+	auto DecodeBudget::depth(uint64_t depth) const -> bool {
+		return depth < _limits.max_depth;
+	}
+	
+	auto DecodeBudget::used_bytes() const -> uint64_t {
+		return _bytes;
+	}
+	
+	auto DecodeBudget::used_items() const -> uint64_t {
+		return _items;
+	}
+}
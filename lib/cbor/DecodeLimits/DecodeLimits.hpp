@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+namespace cbor {
+	/// Bounds of one decoded document, max_bytes is compared with the estimated heap usage of the tree.
+	struct DecodeLimits {
+		uint64_t max_bytes = UINT64_MAX;
+		uint64_t max_depth = UINT64_MAX;
+		uint64_t max_items = UINT64_MAX;
+		uint64_t max_string_length = UINT64_MAX;
+	};
+	
+	/// Usage of one decode, every charge is made from declared sizes before the memory is allocated.
+	/// The methods return false when the charge would exceed a limit.
+	class DecodeBudget {
+	public:
+		DecodeBudget(DecodeLimits const& limits = {});
+		
+		auto limits() const -> DecodeLimits const&;
+		
+		auto reset() -> void;
+		
+		/// Charges the node of an item that was not announced by a container yet.
+		auto item() -> bool;
+		
+		/// Charges the payload of a string or a byte string.
+		auto payload(uint64_t length) -> bool;
+		
+		/// Charges the announced items of an array or a map and the storage for them.
+		auto container(uint64_t count, bool is_map) -> bool;
+		
+		/// Checks a container or tag opened inside depth other containers and tags.
+		auto depth(uint64_t depth) const -> bool;
+		
+		auto used_bytes() const -> uint64_t;
+		
+		auto used_items() const -> uint64_t;
+	
+	private:
+		auto charge(uint64_t bytes) -> bool;
+		
+		DecodeLimits _limits;
+		uint64_t _bytes;
+		uint64_t _items;
+		uint64_t _announced;
+	};
+}
@@ -17,10 +17,61 @@
 #include "Decoder.hpp"
 
 #include <limits.h>
+#include <algorithm>
+#include <new>
 
 namespace cbor {
 	Decoder::Decoder(Input& in) :
-		_in(&in), _state(DecoderState::Type), _minor_type(255) {
+		_in(&in), _state(DecoderState::Type), _minor_type(255), _blob_handler(nullptr), _blob_threshold(0),
+		_blob_handle(0), _blob_size(0), _blob_remaining(0), _interner(nullptr), _limited(false), _validate_utf8(false),
+		_tag_registry(nullptr) {
+	}
+	
+	auto Decoder::set_blob_handler(BlobHandler& handler, uint64_t threshold, size_t chunk_size) -> void {
+		_blob_handler = &handler;
+		_blob_threshold = threshold;
+		_blob_buffer.resize(chunk_size > 0 ? chunk_size : 1);
+	}
+	
+	auto Decoder::set_interner(ObjectInterner& interner) -> void {
+		_interner = &interner;
+	}
+	
+	auto Decoder::set_limits(DecodeLimits const& limits) -> void {
+		_budget = DecodeBudget(limits);
+		_limited = true;
+	}
+	
+	auto Decoder::set_utf8_validation(bool enabled) -> void {
+		_validate_utf8 = enabled;
+	}
+	
+	auto Decoder::set_tag_registry(TagRegistry const& registry) -> void {
+		_tag_registry = &registry;
+	}
+	
+	auto Decoder::charge_head() -> void {
+		if(!_budget.item()) {
+			_state = DecoderState::Error;
+			throw_exception(DecodeException("decode limit exceeded: too many items or bytes"));
+		}
+		charge_payload();
+	}
+	
+	auto Decoder::charge_payload() -> void {
+		if(_state == DecoderState::StringData || _state == DecoderState::BytesData) {
+			if(!_budget.payload((uint64_t)_current_length)) {
+				_state = DecoderState::Error;
+				throw_exception(DecodeException("decode limit exceeded: string too long"));
+			}
+		}
+	}
+	
+	auto Decoder::charge_container(uint64_t count, bool is_map) -> void {
+		if(!_budget.container(count, is_map)) {
+			_state = DecoderState::Error;
+			throw_exception(DecodeException("decode limit exceeded: too many items or bytes"));
+		}
 	}
 	
 	auto Decoder::has_bytes() -> bool {
@@ -43,53 +94,149 @@ namespace cbor {
 		return Object::from_error(error_msg);
 	}
 	
+	/// Interns a finished item and every container it finishes, replacing them in their parents.
+	static auto finish_value(DecodeData& decode_data, PObject value, bool is_key) -> void {
+		auto& open_structures = decode_data.open_structures;
+		while(true) {
+			if(!is_key && decode_data.interner != nullptr) {
+				value = decode_data.interner->intern(value);
+			}
+			if(open_structures.empty()) {
+				decode_data.result = value;
+				return;
+			}
+			auto& open = open_structures.back();
+			if(!is_key && decode_data.interner != nullptr) {
+				*open.slot = value;
+			}
+			if(--open.remaining > 0) {
+				return;
+			}
+			value = open.object;
+			is_key = false;
+			open_structures.pop_back();
+		}
+	}
+	
+	static auto track_value(DecodeData& decode_data, PObject const& value, bool is_key) -> void {
+		if(decode_data.interner == nullptr && decode_data.budget == nullptr) {
+			return;
+		}
+		auto is_map = value->object_type() == ObjectType::Map;
+		if(is_map || value->object_type() == ObjectType::Array || value->is_tagged()) {
+			// open structures are the ancestors of the current item, unlike structures_stack
+			if(decode_data.budget != nullptr && !decode_data.budget->depth(decode_data.open_structures.size())) {
+				throw_exception(DecodeException("decode limit exceeded: too deep"));
+			}
+			if(value->is_tagged()) {
+				decode_data.open_structures.push_back({value, 1, nullptr});
+				return;
+			}
+			if(value->array_or_map_size > 0) {
+				decode_data.open_structures.push_back({value, (uint64_t)value->array_or_map_size * (is_map ? 2 : 1), nullptr});
+				return;
+			}
+		}
+		finish_value(decode_data, value, is_key);
+	}
+	
+	/// Arrays and maps with items and tags, which wait for the item they annotate.
+	static auto opens_structure(Object const& value) -> bool {
+		if(value.object_type() == ObjectType::Array || value.object_type() == ObjectType::Map) {
+			return value.array_or_map_size > 0;
+		}
+		return value.is_tagged();
+	}
+	
+#if CBOR_STATS
+	/// Heap blocks of a decoded node: the node with its control block and a payload that does not fit inline.
+	static auto node_allocations(Object const& value) -> uint64_t {
+		if(value.is_string()) {
+			return value.as_string().size() >= sizeof(std::string) / 2 ? 2 : 1;
+		}
+		if(value.is_bytes()) {
+			return value.as_bytes().empty() ? 1 : 2;
+		}
+		return value.is_map() ? 2 : 1;
+	}
+#endif
+	
 	static auto put_decoded_value(DecodeData& decode_data, PObject value) -> void {
+		CBOR_STATS_ONLY(StatsRecorder::add_allocations(node_allocations(*value));)
+		// value is moved into its slot and used through stored afterwards, saving reference count updates
 		auto old_structures_stack_size = decode_data.structures_stack.size();
 		if(decode_data.structures_stack.empty()) {
 			if(decode_data.result)
-				throw DecodeException("multiple cbor object when decoding");
-			decode_data.result = value;
+				throw_exception(DecodeException("multiple cbor object when decoding"));
+			decode_data.result = std::move(value);
+			auto const& stored = decode_data.result;
 			
-			if(value->object_type() == ObjectType::Array || value->object_type() == ObjectType::Map) {
-				if(value->array_or_map_size > 0) {
-					decode_data.structures_stack.push_back(value);
-				}
+			if(opens_structure(*stored)) {
+				decode_data.structures_stack.push_back(stored);
+				CBOR_STATS_ONLY(StatsRecorder::record_depth(decode_data.structures_stack.size());)
 			}
+			track_value(decode_data, stored, false);
 			return;
 		}
-		auto last = decode_data.structures_stack[old_structures_stack_size - 1];
+		auto is_key = false;
+		PObject* stored = nullptr;
+		auto last = decode_data.structures_stack[old_structures_stack_size - 1].get();
 		if(last->object_type() == ObjectType::Array) {
 			auto& array_value = last->as<ObjectType::Array>();
-			array_value.push_back(value);
+			array_value.push_back(std::move(value));
+			stored = &array_value.back();
+			if(decode_data.interner != nullptr) {
+				decode_data.open_structures.back().slot = stored;
+			}
 			if(array_value.size() >= last->array_or_map_size) {
 				// full, pop from structure
 				decode_data.structures_stack.pop_back();
 			}
 		} else if(last->object_type() == ObjectType::Map) {
-			if(decode_data.iter_in_map_key)
-				decode_data.map_key_temp = value;
-			else {
-				if(decode_data.map_key_temp->object_type() != ObjectType::String) {
-					throw DecodeException("invalid map key type");
+			if(decode_data.iter_in_map_key) {
+				// rejected before the key is tracked, a container key would be finished into an empty value slot
+				if(value->object_type() != ObjectType::String) {
+					throw_exception(DecodeException("invalid map key type"));
 				}
+				decode_data.map_key_temp = std::move(value);
+				stored = &decode_data.map_key_temp;
+				is_key = true;
+			} else {
 				auto const& key = decode_data.map_key_temp->as<ObjectType::String>();
 				auto& map_value = last->as<ObjectType::Map>();
-				map_value[key] = value;
+				auto inserted = map_value.try_emplace(key);
+				if(!inserted.second) {
+					// a repeated key replaces the value and takes one of the announced entries
+					--last->array_or_map_size;
+				}
+				stored = &inserted.first->second;
+				*stored = std::move(value);
+				if(decode_data.interner != nullptr) {
+					decode_data.open_structures.back().slot = stored;
+				}
 				if(map_value.size() >= last->array_or_map_size) {
 					// full, pop from structure
 					decode_data.structures_stack.pop_back();
 				}
 			}
 			decode_data.iter_in_map_key = !decode_data.iter_in_map_key;
+		} else if(last->is_tagged()) {
+			// the tag is a prefix, its item takes the slot of the tag in the parent
+			stored = &last->tagged_item();
+			*stored = std::move(value);
+			if(decode_data.interner != nullptr) {
+				decode_data.open_structures.back().slot = stored;
+			}
+			decode_data.structures_stack.pop_back();
 		} else {
-			throw DecodeException("invalid structure type");
+			throw_exception(DecodeException("invalid structure type"));
 		}
 		
-		if(value->object_type() == ObjectType::Array || value->object_type() == ObjectType::Map) {
-			if(value->array_or_map_size > 0) {
-				decode_data.structures_stack.push_back(value);
-			}
+		if(opens_structure(**stored)) {
+			decode_data.structures_stack.push_back(*stored);
+			CBOR_STATS_ONLY(StatsRecorder::record_depth(decode_data.structures_stack.size());)
 		}
+		track_value(decode_data, *stored, is_key);
 	}
 	
 	auto Decoder::decode_type_p_int() -> void {
@@ -98,7 +245,7 @@ namespace cbor {
 			_current_length = 0;
 		} else if(!decode_type_count_length<DecoderState::PInt, DecoderState::ExtraPInt>(_minor_type)) {
 			_state = DecoderState::Error;
-			throw DecodeException("invalid integer type");
+			throw_exception(DecodeException("invalid integer type"));
 		}
 	}
 	
@@ -108,17 +255,19 @@ namespace cbor {
 			_current_length = 0;
 		} else if(!decode_type_count_length<DecoderState::NInt, DecoderState::ExtraNInt>(_minor_type)) {
 			_state = DecoderState::Error;
-			throw DecodeException("invalid integer type");
+			throw_exception(DecodeException("invalid integer type"));
 		}
 	}
 	
 	auto Decoder::decode_type_bytes() -> void {
 		if(_minor_type < 24) {
+			if(begin_blob(_minor_type))
+				return;
 			_state = DecoderState::BytesData;
 			_current_length = _minor_type;
 		} else if(!decode_type_count_length<DecoderState::BytesSize>(_minor_type)) {
 			_state = DecoderState::Error;
-			throw DecodeException("invalid bytes type");
+			throw_exception(DecodeException("invalid bytes type"));
 		}
 	}
 	
@@ -128,7 +277,7 @@ namespace cbor {
 			_current_length = _minor_type;
 		} else if(!decode_type_count_length<DecoderState::StringSize>(_minor_type)) {
 			_state = DecoderState::Error;
-			throw DecodeException("invalid string type");
+			throw_exception(DecodeException("invalid string type"));
 		}
 	}
 	
@@ -138,7 +287,7 @@ namespace cbor {
 			_current_length = 0;
 		} else if(!decode_type_count_length<DecoderState::Array>(_minor_type)) {
 			_state = DecoderState::Error;
-			throw DecodeException("invalid array type");
+			throw_exception(DecodeException("invalid array type"));
 		}
 	}
 	
@@ -148,7 +297,7 @@ namespace cbor {
 			_current_length = 0;
 		} else if(!decode_type_count_length<DecoderState::Map>(_minor_type)) {
 			_state = DecoderState::Error;
-			throw DecodeException("invalid array type");
+			throw_exception(DecodeException("invalid array type"));
 		}
 	}
 	
@@ -158,7 +307,7 @@ namespace cbor {
 			_current_length = 0;
 		} else if(!decode_type_count_length<DecoderState::Tag, DecoderState::ExtraTag>(_minor_type)) {
 			_state = DecoderState::Error;
-			throw DecodeException("invalid tag type");
+			throw_exception(DecodeException("invalid tag type"));
 		}
 	}
 	
@@ -180,7 +329,7 @@ namespace cbor {
 			_current_length = 0;
 		} else if(!decode_type_count_length<DecoderState::Special, DecoderState::ExtraSpecial>(_minor_type)) {
 			_state = DecoderState::Error;
-			throw DecodeException("invalid special type");
+			throw_exception(DecodeException("invalid special type"));
 		}
 	}
 	
@@ -230,7 +379,7 @@ namespace cbor {
 				return _in->get_int32();
 		}
 		_state = DecoderState::Error;
-		throw DecodeException("incorrect length");
+		throw_exception(DecodeException("incorrect length"));
 	}
 	
 	auto Decoder::decode_n_int() -> IntValue {
@@ -246,33 +395,67 @@ namespace cbor {
 				return -(int64_t)_in->get_int32() - 1;
 		}
 		_state = DecoderState::Error;
-		throw DecodeException("incorrect length");
+		throw_exception(DecodeException("incorrect length"));
 	}
 	
 	auto Decoder::decode_bytes_size() -> void {
-		if(_current_length != 8) {
-			_state = DecoderState::BytesData;
-			switch(_current_length) {
-				case 1:
-					_current_length = _in->get_int8();
-					break;
-				case 2:
-					_current_length = _in->get_int16();
-					break;
-				case 4:
-					_current_length = _in->get_int32();
-					break;
-			}
-		} else {
+		uint64_t size = 0;
+		switch(_current_length) {
+			case 1:
+				size = _in->get_int8();
+				break;
+			case 2:
+				size = _in->get_int16();
+				break;
+			case 4:
+				size = _in->get_int32();
+				break;
+			case 8:
+				size = _in->get_int64();
+				break;
+		}
+		if(begin_blob(size))
+			return;
+		if(_current_length == 8 || size > INT_MAX) {
 			_state = DecoderState::Error;
-			throw DecodeException("extra long bytes");
+			throw_exception(DecodeException("extra long bytes"));
 		}
+		_state = DecoderState::BytesData;
+		_current_length = (int)size;
+	}
+	
+	auto Decoder::begin_blob(uint64_t size) -> bool {
+		if(_blob_handler == nullptr || size < _blob_threshold)
+			return false;
+		_state = DecoderState::BlobData;
+		_current_length = 0;
+		_blob_size = size;
+		_blob_remaining = size;
+		_blob_handle = _blob_handler->begin(size);
+		return true;
+	}
+	
+	auto Decoder::decode_blob_data(DecodeData& decode_data) -> bool {
+		while(_blob_remaining > 0) {
+			auto count = (int)std::min<uint64_t>(_blob_remaining, _blob_buffer.size());
+			if(!_in->has_bytes(count))
+				return false;
+			_in->get_bytes(_blob_buffer.data(), count);
+			CBOR_STATS_ONLY(StatsRecorder::add_bytes_copied(count);)
+			_blob_handler->chunk(_blob_handle, _blob_buffer.data(), count);
+			_blob_remaining -= count;
+		}
+		_state = DecoderState::Type;
+		_blob_handler->end(_blob_handle);
+		put_decoded_value(decode_data, Object::from_blob({_blob_handle, _blob_size}));
+		return true;
 	}
 	
 	auto Decoder::decode_bytes_data() -> BytesValue {
 		_state = DecoderState::Type;
 		std::vector<char> data(_current_length);
 		_in->get_bytes(data.data(), _current_length);
+		CBOR_STATS_ONLY(StatsRecorder::add_bytes_copied(_current_length);)
 		return data;
 	}
 	
@@ -292,15 +475,20 @@ namespace cbor {
 			}
 		} else {
 			_state = DecoderState::Error;
-			throw DecodeException("extra long array");
+			throw_exception(DecodeException("extra long array"));
 		}
 	}
 	
 	auto Decoder::decode_string_data() -> StringValue {
 		_state = DecoderState::Type;
-		std::vector<char> data(_current_length);
-		_in->get_bytes(data.data(), _current_length);
-		std::string str(data.data(), (size_t)_current_length);
+		std::string str((size_t)_current_length, '\0');
+		_in->get_bytes(str.data(), _current_length);
+		CBOR_STATS_ONLY(StatsRecorder::add_bytes_copied(_current_length);)
+		// checked right after the copy, while the string is still in cache
+		if(_validate_utf8 && !is_valid_utf8(str.data(), str.size())) {
+			_state = DecoderState::Error;
+			throw_exception(DecodeException("invalid utf-8 string"));
+		}
 		return str;
 	}
 	
@@ -319,7 +507,7 @@ namespace cbor {
 			}
 		}
 		_state = DecoderState::Error;
-		throw DecodeException("extra long array");
+		throw_exception(DecodeException("extra long array"));
 	}
 	
 	auto Decoder::decode_map_size() -> uint32_t {
@@ -337,10 +525,10 @@ namespace cbor {
 			}
 		}
 		_state = DecoderState::Error;
-		throw DecodeException("extra long map");
+		throw_exception(DecodeException("extra long map"));
 	}
 	
-	auto Decoder::decode_tag() -> TagValue {
+	auto Decoder::decode_tag() -> uint32_t {
 		_state = DecoderState::Type;
 		switch(_current_length) {
 			case 0:
@@ -353,7 +541,7 @@ namespace cbor {
 				return _in->get_int32();
 		}
 		_state = DecoderState::Error;
-		throw DecodeException("extra long tag");
+		throw_exception(DecodeException("extra long tag"));
 	}
 	
 	auto Decoder::decode_special() -> SpecialValue {
@@ -369,7 +557,7 @@ namespace cbor {
 				return _in->get_int32();
 		}
 		_state = DecoderState::Error;
-		throw DecodeException("extra long special");
+		throw_exception(DecodeException("extra long special"));
 	}
 	
 	auto Decoder::decode_extra_p_int() -> ExtraIntValue {
@@ -382,7 +570,7 @@ namespace cbor {
 		return {false, _in->get_int64() + 1};
 	}
 	
-	auto Decoder::decode_extra_tag() -> ExtraTagValue {
+	auto Decoder::decode_extra_tag() -> uint64_t {
 		_state = DecoderState::Type;
 		return _in->get_int64();
 	}
@@ -392,90 +580,201 @@ namespace cbor {
 		return _in->get_int64();
 	}
 	
-	auto Decoder::run() -> PObject {
-		DecodeData decode_data{};
-		
-		while(true) {
-			if(_state == DecoderState::Error) {
+	/// Puts the native value of a handled tag in place of the tag, returns false for other tags.
+	auto Decoder::decode_native(DecodeData& decode_data, uint64_t tag) -> bool {
+		if(_tag_registry == nullptr) {
+			return false;
+		}
+		auto decode = _tag_registry->find(tag);
+		if(decode == nullptr) {
+			return false;
+		}
+		Reader reader(*_in);
+		put_decoded_value(decode_data, Object::from_native(decode(reader, tag)));
+		return true;
+	}
+	
+	auto Decoder::step(DecodeData& decode_data) -> bool {
+		CBOR_STATS_ONLY(StateTimer timer((size_t)_state);)
+		if(_state == DecoderState::Error) {
+			return false;
+		} else if(_state == DecoderState::Type) {
+			if(!_in->has_bytes(1))
+				return false;
+			decode_type();
+			if(_limited)
+				charge_head();
+			return true;
+		} else if(_state == DecoderState::BlobData) {
+			return decode_blob_data(decode_data);
+		}
+		if(!_in->has_bytes(_current_length))
+			return false;
+		switch(_state) {
+			case DecoderState::PInt:
+				put_decoded_value(decode_data, Object::from_int(decode_p_int()));
 				break;
-			} else if(_state == DecoderState::Type) {
-				if(!_in->has_bytes(1))
-					break;
-				decode_type();
-			} else {
-				if(!_in->has_bytes(_current_length))
+			case DecoderState::NInt:
+				put_decoded_value(decode_data, Object::from_int(decode_n_int()));
+				break;
+			case DecoderState::BytesSize:
+				decode_bytes_size();
+				if(_limited)
+					charge_payload();
+				break;
+			case DecoderState::BytesData:
+				put_decoded_value(decode_data, Object::from_bytes(decode_bytes_data()));
+				break;
+			case DecoderState::StringSize:
+				decode_string_size();
+				if(_limited)
+					charge_payload();
+				break;
+			case DecoderState::StringData:
+				put_decoded_value(decode_data, Object::from_string(decode_string_data()));
+				break;
+			case DecoderState::Array: {
+				auto size = decode_array_size();
+				if(!_limited) {
+					put_decoded_value(decode_data, Object::create_array(size));
 					break;
-				switch(_state) {
-					case DecoderState::PInt:
-						put_decoded_value(decode_data, Object::from_int(decode_p_int()));
-						break;
-					case DecoderState::NInt:
-						put_decoded_value(decode_data, Object::from_int(decode_n_int()));
-						break;
-					case DecoderState::BytesSize:
-						decode_bytes_size();
-						break;
-					case DecoderState::BytesData:
-						put_decoded_value(decode_data, Object::from_bytes(decode_bytes_data()));
-						break;
-					case DecoderState::StringSize:
-						decode_string_size();
-						break;
-					case DecoderState::StringData:
-						put_decoded_value(decode_data, Object::from_string(decode_string_data()));
-						break;
-					case DecoderState::Array:
-						put_decoded_value(decode_data, Object::create_array(decode_array_size()));
-						break;
-					case DecoderState::Map:
-						put_decoded_value(decode_data, Object::create_map(decode_map_size()));
-						break;
-					case DecoderState::Tag:
-						put_decoded_value(decode_data, Object::from_tag(decode_tag()));
-						break;
-					case DecoderState::Special:
-						put_decoded_value(decode_data, Object::from_special(decode_special()));
-						break;
-					case DecoderState::BoolFalse:
-						_state = DecoderState::Type;
-						put_decoded_value(decode_data, Object::from_bool(false));
-						break;
-					case DecoderState::BoolTrue:
-						_state = DecoderState::Type;
-						put_decoded_value(decode_data, Object::from_bool(true));
-						break;
-					case DecoderState::Null:
-						_state = DecoderState::Type;
-						put_decoded_value(decode_data, Object::create_null());
-						break;
-					case DecoderState::Undefined:
-						_state = DecoderState::Type;
-						put_decoded_value(decode_data, Object::create_undefined());
-						break;
-					case DecoderState::ExtraPInt:
-						put_decoded_value(decode_data, Object::from_extra_int(decode_extra_p_int()));
-						break;
-					case DecoderState::ExtraNInt:
-						put_decoded_value(decode_data, Object::from_extra_int(decode_extra_n_int()));
-						break;
-					case DecoderState::ExtraTag:
-						put_decoded_value(decode_data, Object::from_extra_tag(decode_extra_tag()));
-						break;
-					case DecoderState::ExtraSpecial:
-						put_decoded_value(decode_data, Object::from_extra_special(decode_extra_special()));
-						break;
-					default:
-						break;
 				}
+				charge_container(size, false);
+				// sized once, but never beyond the buffered bytes, each item takes at least one of them
+				auto array = Object::create_array(size);
+				array->as<ObjectType::Array>().reserve(std::min<size_t>(size, (size_t)_in->buffered()));
+				put_decoded_value(decode_data, std::move(array));
+				break;
 			}
+			case DecoderState::Map: {
+				auto size = decode_map_size();
+				if(_limited)
+					charge_container(size, true);
+				put_decoded_value(decode_data, Object::create_map(size));
+				break;
+			}
+			case DecoderState::Tag: {
+				auto tag = decode_tag();
+				if(!decode_native(decode_data, tag))
+					put_decoded_value(decode_data, Object::from_tag(TagValue{tag, nullptr}));
+				break;
+			}
+			case DecoderState::Special:
+				put_decoded_value(decode_data, Object::from_special(decode_special()));
+				break;
+			case DecoderState::BoolFalse:
+				_state = DecoderState::Type;
+				put_decoded_value(decode_data, Object::from_bool(false));
+				break;
+			case DecoderState::BoolTrue:
+				_state = DecoderState::Type;
+				put_decoded_value(decode_data, Object::from_bool(true));
+				break;
+			case DecoderState::Null:
+				_state = DecoderState::Type;
+				put_decoded_value(decode_data, Object::create_null());
+				break;
+			case DecoderState::Undefined:
+				_state = DecoderState::Type;
+				put_decoded_value(decode_data, Object::create_undefined());
+				break;
+			case DecoderState::ExtraPInt:
+				put_decoded_value(decode_data, Object::from_extra_int(decode_extra_p_int()));
+				break;
+			case DecoderState::ExtraNInt:
+				put_decoded_value(decode_data, Object::from_extra_int(decode_extra_n_int()));
+				break;
+			case DecoderState::ExtraTag: {
+				auto tag = decode_extra_tag();
+				if(!decode_native(decode_data, tag))
+					put_decoded_value(decode_data, Object::from_extra_tag(ExtraTagValue{tag, nullptr}));
+				break;
+			}
+			case DecoderState::ExtraSpecial:
+				put_decoded_value(decode_data, Object::from_extra_special(decode_extra_special()));
+				break;
+			default:
+				break;
+		}
+		return true;
+	}
+	
+	auto Decoder::run() -> PObject {
+		DecodeData decode_data{};
+		decode_data.interner = _interner;
+		if(_limited) {
+			_budget.reset();
+			decode_data.budget = &_budget;
+		}
+		
+		while(step(decode_data)) {
 		}
 		if(!decode_data.result)
-			throw DecodeException("cbor decoded nothing");
+			throw_exception(DecodeException("cbor decoded nothing"));
 		if(!decode_data.structures_stack.empty())
-			throw DecodeException("cbor decode fail with not finished structures");
+			throw_exception(DecodeException("cbor decode fail with not finished structures"));
+		return decode_data.result;
+	}
+	
+	auto Decoder::next() -> PObject {
+		DecodeData decode_data{};
+		decode_data.interner = _interner;
+		if(_limited) {
+			_budget.reset();
+			decode_data.budget = &_budget;
+		}
+		
+		while(!decode_data.result || !decode_data.structures_stack.empty()) {
+			if(!step(decode_data)) {
+				if(!decode_data.result && _state == DecoderState::Type)
+					return nullptr;
+				throw_exception(DecodeException("cbor decode fail with not finished structures"));
+			}
+		}
 		return decode_data.result;
 	}
 	
 	Decoder::~Decoder() {
 	}
+	
+	/// Decodes a validated buffer, allocation failures are reported instead of thrown when exceptions are enabled.
+	static auto decode_validated(const void* data, size_t size, PObject& result) -> Error {
+		Input input((void*)data, (int)size);
+#if CBOR_EXCEPTIONS
+		try {
+			result = Decoder(input).run();
+		} catch(std::bad_alloc const&) {
+			result = nullptr;
+			return {ErrorCode::OutOfMemory, 0};
+		}
+#else
+		result = Decoder(input).run();
+#endif
+		return {};
+	}
+	
+	auto try_decode(const void* data, size_t size, PObject& result) -> Error {
+		if(size > INT_MAX) {
+			return {ErrorCode::TooLong, 0};
+		}
+		thread_local Validator validator;
+		auto error = validator.check(data, size);
+		if(error) {
+			return error;
+		}
+		return decode_validated(data, size, result);
+	}
+	
+	auto try_decode(const void* data, size_t size, PObject& result, DecodeLimits const& limits) -> Error {
+		if(size > INT_MAX) {
+			return {ErrorCode::TooLong, 0};
+		}
+		thread_local Validator validator;
+		auto error = validator.check(data, size, limits);
+		if(error) {
+			return error;
+		}
+		// the validator charged the same budget, the decoder does not have to check it again
+		return decode_validated(data, size, result);
+	}
 }
@@ -18,6 +18,12 @@
 
 #include "../Input/Input.hpp"
 #include "../Object/Object.hpp"
+#include "../ObjectInterner/ObjectInterner.hpp"
+#include "../Validator/Validator.hpp"
+#include "../DecodeLimits/DecodeLimits.hpp"
+#include "../Utf8/Utf8.hpp"
+#include "../Stats/Stats.hpp"
+#include "../TagHandler/TagHandler.hpp"
 
 namespace cbor {
 	enum class DecoderState {
@@ -41,6 +47,16 @@ namespace cbor {
 		ExtraNInt,
 		ExtraTag,
 		ExtraSpecial,
+		BlobData,
+	};
+	
+	static_assert((size_t)DecoderState::BlobData + 1 == decoder_state_count, "decoder_state_count is out of date");
+	
+	/// Container whose items are not all finished yet, slot is where its last item was stored.
+	struct OpenStructure {
+		PObject object;
+		uint64_t remaining;
+		PObject* slot;
 	};
 	
 	struct DecodeData {
@@ -48,6 +64,22 @@ namespace cbor {
 		std::vector<PObject> structures_stack;
 		bool iter_in_map_key = true;
 		PObject map_key_temp;
+		ObjectInterner* interner = nullptr;
+		DecodeBudget* budget = nullptr;
+		std::vector<OpenStructure> open_structures;
+	};
+	
+	/// Receives byte strings above the Decoder blob threshold in chunks, the tree keeps only a BlobValue.
+	class BlobHandler {
+	public:
+		/// Returns the handle stored in the BlobValue.
+		virtual auto begin(uint64_t size) -> uint64_t = 0;
+		
+		virtual auto chunk(uint64_t handle, const uint8_t* data, size_t size) -> void = 0;
+		
+		virtual auto end(uint64_t handle) -> void = 0;
+		
+		virtual ~BlobHandler() = default;
 	};
 	
 	class Decoder {
@@ -96,7 +128,7 @@ namespace cbor {
 		
 		auto decode_map_size() -> uint32_t;
 		
-		auto decode_tag() -> TagValue;
+		auto decode_tag() -> uint32_t;
 		
 		auto decode_special() -> SpecialValue;
 		
@@ -104,15 +136,48 @@ namespace cbor {
 		
 		auto decode_extra_n_int() -> ExtraIntValue;
 		
-		auto decode_extra_tag() -> ExtraTagValue;
+		auto decode_extra_tag() -> uint64_t;
 		
 		auto decode_extra_special() -> ExtraSpecialValue;
 		
+		/// Streams byte strings of at least threshold bytes to handler in chunks of chunk_size bytes.
+		auto set_blob_handler(BlobHandler& handler, uint64_t threshold, size_t chunk_size = 65536) -> void;
+		
+		/// Replaces finished subtrees by equal nodes kept in interner, the decoded trees must not be modified.
+		auto set_interner(ObjectInterner& interner) -> void;
+		
+		/// Rejects documents over limits before allocating for them, each run or next call has its own budget.
+		auto set_limits(DecodeLimits const& limits) -> void;
+		
+		/// Rejects text strings and map keys that are not valid UTF-8, off by default.
+		auto set_utf8_validation(bool enabled) -> void;
+		
+		/// Decodes the items of tags that registry handles straight into Native nodes, registry must outlive the decoder.
+		/// Handlers read their item at once through a Reader, refillable inputs load more bytes as needed.
+		auto set_tag_registry(TagRegistry const& registry) -> void;
+		
 		auto run() -> PObject;
 		
+		/// Decodes one item of a CBOR sequence, returns nullptr at the end of the input.
+		auto next() -> PObject;
+		
 		~Decoder();
 	
 	private:
+		auto step(DecodeData& decode_data) -> bool;
+		
+		auto begin_blob(uint64_t size) -> bool;
+		
+		auto decode_blob_data(DecodeData& decode_data) -> bool;
+		
+		auto decode_native(DecodeData& decode_data, uint64_t tag) -> bool;
+		
+		auto charge_head() -> void;
+		
+		auto charge_payload() -> void;
+		
+		auto charge_container(uint64_t count, bool is_map) -> void;
+		
 		template<DecoderState State, DecoderState LastState = State>
 		auto decode_type_count_length(unsigned char minor_type) -> bool;
 		
@@ -120,7 +185,25 @@ namespace cbor {
 		DecoderState _state;
 		int _current_length;
 		uint8_t _minor_type;
+		BlobHandler* _blob_handler;
+		uint64_t _blob_threshold;
+		std::vector<uint8_t> _blob_buffer;
+		uint64_t _blob_handle;
+		uint64_t _blob_size;
+		uint64_t _blob_remaining;
+		ObjectInterner* _interner;
+		DecodeBudget _budget;
+		bool _limited;
+		bool _validate_utf8;
+		TagRegistry const* _tag_registry;
 	};
+	
+	/// Decodes one document without throwing on malformed input, the buffer is validated first.
+	/// Running out of memory is reported as ErrorCode::OutOfMemory, builds without exceptions abort instead.
+	auto try_decode(const void* data, size_t size, PObject& result) -> Error;
+	
+	/// Same as try_decode, documents over limits are reported as ErrorCode::LimitExceeded.
+	auto try_decode(const void* data, size_t size, PObject& result, DecodeLimits const& limits) -> Error;
 }
 
 #include "Decoder.inl"
@@ -0,0 +1,186 @@
+#include "EncodeCache.hpp"
+#include "../Encoder/Encoder.hpp"
+
+namespace cbor {
+	static auto is_container(PObject const& node) -> bool {
+		return node && (node->is_array() || node->is_map() || node->is_tagged());
+	}
+	
+	template<typename Visit_>
+	static auto for_each_child(Object const& container, Visit_&& visit) -> void {
+		if(container.is_array()) {
+			for(auto const& item: container.as_array()) {
+				visit(item);
+			}
+		} else if(container.is_tagged()) {
+			visit(container.tagged_item());
+		} else {
+			for(auto const& p: container.as_map()) {
+				visit(p.second);
+			}
+		}
+	}
+	
+	EncodeCache::EncodeCache(size_t chunk_size) :
+		_chunk_size(chunk_size), _pass(0) {
+	}
+	
+	auto EncodeCache::encode(Output& output, PObject const& root) -> void {
+		// iterative like Encoder::write_object, deeply nested trees do not grow the call stack
+		_buffer.reset();
+		_stack.clear();
+		++_pass;
+		auto item = &root;
+		Object const* parent = nullptr;
+		while(true) {
+			if(item != nullptr) {
+				open(*item, parent);
+			}
+			if(_stack.empty()) {
+				break;
+			}
+			auto& frame = _stack.back();
+			auto const& node = **frame.node;
+			item = nullptr;
+			if(node.is_array()) {
+				auto const& array_value = node.as_array();
+				if(frame.index < array_value.size()) {
+					item = &array_value[frame.index++];
+				}
+			} else if(node.is_tagged()) {
+				if(frame.index++ == 0) {
+					item = &node.tagged_item();
+				}
+			} else if(frame.it != node.as_map().end()) {
+				Encoder(_buffer).write_string(frame.it->first.data(), (uint32_t)frame.it->first.size());
+				item = &frame.it->second;
+				++frame.it;
+			}
+			if(item == nullptr) {
+				finish(frame);
+				_stack.pop_back();
+			} else {
+				parent = &node;
+			}
+		}
+		output.put_bytes(_buffer.data(), _buffer.size());
+	}
+	
+	auto EncodeCache::drop_bytes(PObject const& node) -> void {
+		if(is_container(node)) {
+			auto it = _entries.find(node.get());
+			if(it != _entries.end()) {
+				std::vector<uint8_t>().swap(it->second.bytes);
+			}
+		}
+	}
+	
+	auto EncodeCache::open(PObject const& node, Object const* parent) -> void {
+		if(!is_container(node)) {
+			Encoder(_buffer).write_object(node);
+			return;
+		}
+		// references into an unordered_map stay valid while later nodes are inserted
+		auto& entry = _entries[node.get()];
+		if(entry.pass == _pass) {
+			throw_exception(EncodeException("node is shared between containers"));
+		}
+		entry.pass = _pass;
+		entry.node = node;
+		entry.parent = parent;
+		if(!entry.bytes.empty()) {
+			_buffer.put_bytes(entry.bytes.data(), entry.bytes.size());
+			return;
+		}
+		
+		auto start = _buffer.size();
+		Encoder encoder(_buffer);
+		if(node->is_array()) {
+			encoder.write_array(node->as_array().size());
+			_stack.push_back({&node, &entry, start, 0, {}});
+		} else if(node->is_tagged()) {
+			encoder.write_tag(node->tag_number());
+			_stack.push_back({&node, &entry, start, 0, {}});
+		} else {
+			encoder.write_map(node->as_map().size());
+			_stack.push_back({&node, &entry, start, 0, node->as_map().begin()});
+		}
+	}
+	
+	auto EncodeCache::finish(Frame const& frame) -> void {
+		auto size = _buffer.size() - frame.start;
+		if(size > _chunk_size) {
+			return;
+		}
+		// the children are covered by this copy, keep only the outermost one
+		frame.entry->bytes.assign(_buffer.data() + frame.start, _buffer.data() + frame.start + size);
+		for_each_child(**frame.node, [this](PObject const& child) {
+			drop_bytes(child);
+		});
+	}
+	
+	auto EncodeCache::invalidate(Object const* container) -> void {
+		auto it = _entries.find(container);
+		while(it != _entries.end()) {
+			std::vector<uint8_t>().swap(it->second.bytes);
+			it = it->second.parent != nullptr ? _entries.find(it->second.parent) : _entries.end();
+		}
+	}
+	
+	auto EncodeCache::forget(PObject const& node) -> void {
+		std::vector<Object const*> stack;
+		if(is_container(node)) {
+			stack.push_back(node.get());
+		}
+		while(!stack.empty()) {
+			auto current = stack.back();
+			stack.pop_back();
+			_entries.erase(current);
+			for_each_child(*current, [&stack](PObject const& child) {
+				if(is_container(child)) {
+					stack.push_back(child.get());
+				}
+			});
+		}
+	}
+	
+	auto EncodeCache::set(PObject const& map, std::string const& key, PObject value) -> void {
+		auto& map_value = map->as<ObjectType::Map>();
+		auto& slot = map_value[key];
+		forget(slot);
+		slot = std::move(value);
+		map->array_or_map_size = (uint32_t)map_value.size();
+		invalidate(map.get());
+	}
+	
+	auto EncodeCache::set(PObject const& array, size_t index, PObject value) -> void {
+		auto& slot = array->as<ObjectType::Array>().at(index);
+		forget(slot);
+		slot = std::move(value);
+		invalidate(array.get());
+	}
+	
+	auto EncodeCache::push_back(PObject const& array, PObject value) -> void {
+		auto& array_value = array->as<ObjectType::Array>();
+		array_value.push_back(std::move(value));
+		array->array_or_map_size = (uint32_t)array_value.size();
+		invalidate(array.get());
+	}
+	
+	auto EncodeCache::erase(PObject const& map, std::string const& key) -> void {
+		auto& map_value = map->as<ObjectType::Map>();
+		auto it = map_value.find(key);
+		if(it == map_value.end()) {
+			return;
+		}
+		forget(it->second);
+		map_value.erase(it);
+		map->array_or_map_size = (uint32_t)map_value.size();
+		invalidate(map.get());
+	}
+	
+	auto EncodeCache::clear() -> void {
+		_entries.clear();
+		_buffer.reset();
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../OutputDynamic/OutputDynamic.hpp"
+#include "../Object/Object.hpp"
+#include <unordered_map>
+
+namespace cbor {
+	/// Keeps the encoded bytes of subtrees of at most chunk_size bytes so that re-encoding a tree
+	/// copies clean subtrees and only walks the containers changed through the mutation methods.
+	/// Nodes must not be shared between several containers of the tree, so trees decoded with an
+	/// ObjectInterner cannot be cached; encode throws when it meets a container a second time.
+	class EncodeCache {
+	public:
+		EncodeCache(size_t chunk_size = 65536);
+		
+		/// Writes the same bytes as Encoder::write_object.
+		auto encode(Output& output, PObject const& root) -> void;
+		
+		auto set(PObject const& map, std::string const& key, PObject value) -> void;
+		
+		auto set(PObject const& array, size_t index, PObject value) -> void;
+		
+		auto push_back(PObject const& array, PObject value) -> void;
+		
+		auto erase(PObject const& map, std::string const& key) -> void;
+		
+		/// Marks a container and its ancestors dirty, call it after changing the container or its scalars in place.
+		auto invalidate(Object const* container) -> void;
+		
+		auto clear() -> void;
+	
+	private:
+		struct Entry {
+			PObject node;
+			Object const* parent = nullptr;
+			std::vector<uint8_t> bytes;
+			uint64_t pass = 0;
+		};
+		
+		/// Container whose children are being written, start is where its head begins in the buffer.
+		struct Frame {
+			PObject const* node;
+			Entry* entry;
+			size_t start;
+			size_t index;
+			MapValue::const_iterator it;
+		};
+		
+		/// Writes a leaf or cached bytes, or the head of a container whose frame is pushed.
+		auto open(PObject const& node, Object const* parent) -> void;
+		
+		/// Keeps the bytes of a finished container that fit into a chunk.
+		auto finish(Frame const& frame) -> void;
+		
+		auto drop_bytes(PObject const& node) -> void;
+		
+		auto forget(PObject const& node) -> void;
+		
+		size_t _chunk_size;
+		std::unordered_map<Object const*, Entry> _entries;
+		OutputDynamic _buffer;
+		uint64_t _pass;
+		std::vector<Frame> _stack;
+	};
+}
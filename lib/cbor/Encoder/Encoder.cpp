@@ -15,15 +15,42 @@
 */
 
 #include "Encoder.hpp"
+#include "../Utf8/Utf8.hpp"
+#include "../OutputCounter/OutputCounter.hpp"
+
+#include <string.h>
+#include <algorithm>
+#include <new>
 
 namespace cbor {
 	Encoder::Encoder(Output& out) {
 		_out = &out;
+		_validate_utf8 = false;
+		_deterministic = false;
 	}
 	
 	Encoder::~Encoder() {
 	}
 	
+	auto Encoder::set_utf8_validation(bool enabled) -> void {
+		_validate_utf8 = enabled;
+	}
+	
+	auto Encoder::set_deterministic(bool enabled) -> void {
+		_deterministic = enabled;
+	}
+	
+	auto Encoder::set_options(EncodeOptions const& options) -> void {
+		_validate_utf8 = options.validate_utf8;
+		_deterministic = options.deterministic;
+	}
+	
+	auto Encoder::check_utf8(const char* data, size_t size) const -> void {
+		if(_validate_utf8 && !is_valid_utf8(data, size)) {
+			throw_exception(EncodeException("invalid utf-8 string"));
+		}
+	}
+	
 	auto Encoder::write_type_value(int major_type, uint32_t value) -> void {
 		major_type <<= 5;
 		if(value < 24) {
@@ -104,15 +131,27 @@ namespace cbor {
 	}
 	
 	auto Encoder::write_string(const char* data, uint32_t size) -> void {
+		check_utf8(data, size);
 		write_type_value(3, size);
 		_out->put_bytes((const uint8_t*)data, size);
 	}
 	
 	auto Encoder::write_string(const std::string str) -> void {
+		check_utf8(str.data(), str.size());
 		write_type_value(3, (uint32_t)str.size());
 		_out->put_bytes((const uint8_t*)str.c_str(), (int)str.size());
 	}
 	
+	auto Encoder::write_bytes_ref(const uint8_t* data, uint32_t size) -> void {
+		write_type_value(2, size);
+		_out->put_reference(data, size);
+	}
+	
+	auto Encoder::write_string_ref(const char* data, uint32_t size) -> void {
+		check_utf8(data, size);
+		write_type_value(3, size);
+		_out->put_reference((const uint8_t*)data, size);
+	}
 	
 	auto Encoder::write_array(int size) -> void {
 		write_type_value(4, (uint32_t)size);
@@ -122,7 +161,7 @@ namespace cbor {
 		write_type_value(5, (uint32_t)size);
 	}
 	
-	auto Encoder::write_tag(const uint32_t tag) -> void {
+	auto Encoder::write_tag(uint64_t tag) -> void {
 		write_type_value(6, tag);
 	}
 	
@@ -130,6 +169,71 @@ namespace cbor {
 		write_type_value(7, (uint32_t)special);
 	}
 	
+	/// Converts a float to a half when no precision is lost.
+	static auto half_from_float(float value, uint16_t& result) -> bool {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		auto sign = (uint16_t)((bits >> 16) & 0x8000);
+		auto exponent = (int)((bits >> 23) & 0xff);
+		auto mantissa = bits & 0x7fffff;
+		if(exponent == 0xff || (exponent == 0 && mantissa == 0)) {
+			// infinity or zero, NaN is handled by the caller
+			result = (uint16_t)(sign | (exponent == 0xff ? 0x7c00 : 0));
+			return true;
+		}
+		exponent -= 127;
+		if(exponent >= -14 && exponent <= 15) {
+			if((mantissa & 0x1fff) != 0) {
+				return false;
+			}
+			result = (uint16_t)(sign | ((exponent + 15) << 10) | (mantissa >> 13));
+			return true;
+		}
+		if(exponent >= -24 && exponent < -14) {
+			// subnormal half, the implicit bit becomes part of the mantissa
+			auto full = mantissa | 0x800000;
+			auto shift = -exponent - 1;
+			if((full & ((1u << shift) - 1)) != 0) {
+				return false;
+			}
+			result = (uint16_t)(sign | (full >> shift));
+			return true;
+		}
+		return false;
+	}
+	
+	auto Encoder::write_double(double value) -> void {
+		if(value != value) {
+			_out->put_byte(0xf9);
+			_out->put_byte(0x7e);
+			_out->put_byte(0x00);
+			return;
+		}
+		auto single = (float)value;
+		if((double)single != value) {
+			uint64_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			_out->put_byte(0xfb);
+			for(int shift = 56; shift >= 0; shift -= 8) {
+				_out->put_byte((uint8_t)(bits >> shift));
+			}
+			return;
+		}
+		uint16_t half;
+		if(half_from_float(single, half)) {
+			_out->put_byte(0xf9);
+			_out->put_byte((uint8_t)(half >> 8));
+			_out->put_byte((uint8_t)half);
+			return;
+		}
+		uint32_t bits;
+		memcpy(&bits, &single, sizeof(bits));
+		_out->put_byte(0xfa);
+		for(int shift = 24; shift >= 0; shift -= 8) {
+			_out->put_byte((uint8_t)(bits >> shift));
+		}
+	}
+	
 	auto Encoder::write_bool(bool value) -> void {
 		if(value) {
 			_out->put_byte((uint8_t)0xf5);
@@ -146,10 +250,38 @@ namespace cbor {
 		_out->put_byte((uint8_t)0xf7);
 	}
 	
-	auto Encoder::write_object(PObject value) -> void {
-		if(!value)
-			return;
-		switch(value->object_type()) {
+	auto Encoder::write_node(Object const& value) -> void {
+		switch(value.object_type()) {
+			case ObjectType::Array: {
+				auto const& array_value = value.as_array();
+				write_type_value(4, (uint64_t)array_value.size());
+				if(!array_value.empty()) {
+					_stack.push_back({&value, 0, {}, 0});
+				}
+				return;
+			}
+			case ObjectType::Map: {
+				auto const& map_value = value.as_map();
+				write_type_value(5, (uint64_t)map_value.size());
+				if(!map_value.empty()) {
+					auto order = _order.size();
+					if(_deterministic) {
+						_key_order.append(map_value, _order);
+					}
+					_stack.push_back({&value, 0, map_value.begin(), order});
+				}
+				return;
+			}
+			case ObjectType::String: {
+				auto const& string_value = value.as_string();
+				write_string(string_value.data(), (uint32_t)string_value.size());
+				return;
+			}
+			case ObjectType::Bytes: {
+				auto const& bytes_value = value.as_bytes();
+				write_bytes((const uint8_t*)bytes_value.data(), (uint32_t)bytes_value.size());
+				return;
+			}
 			case ObjectType::Null:
 				write_null();
 				return;
@@ -157,54 +289,244 @@ namespace cbor {
 				write_undefined();
 				return;
 			case ObjectType::Bool:
-				write_bool(value->as_bool());
+				write_bool(value.as_bool());
 				return;
 			case ObjectType::Int:
-				write_int(value->as_int());
+				write_int(value.as_int());
 				return;
 			case ObjectType::ExtraInt:
-				write_int(value->as<ObjectType::ExtraInt>().second);
-				return;
-			case ObjectType::String:
-				write_string(value->as_string());
+				write_int(value.as<ObjectType::ExtraInt>().second);
 				return;
-			case ObjectType::Bytes: {
-				auto const& bytes = value->as_bytes();
-				write_bytes((const uint8_t*)bytes.data(), bytes.size());
-				return;
-			}
 			case ObjectType::Tag:
-				write_tag(value->as_tag());
-				return;
 			case ObjectType::ExtraTag:
-				write_tag(value->as<ObjectType::ExtraTag>());
+				write_tag(value.tag_number());
+				if(value.tagged_item()) {
+					_stack.push_back({&value, 0, {}, 0});
+				}
 				return;
 			case ObjectType::Special:
-				write_special(value->as_special());
+				write_special(value.as_special());
 				return;
 			case ObjectType::ExtraSpecial:
-				write_special(value->as<ObjectType::ExtraSpecial>());
+				write_special(value.as<ObjectType::ExtraSpecial>());
 				return;
-			case ObjectType::Array: {
-				auto const& array_value = value->as_array();
-				write_array(array_value.size());
-				for(auto const& item: array_value) {
-					write_object(item);
-				}
+			case ObjectType::Native:
+				value.as_native()->encode(*this);
 				return;
+			case ObjectType::Blob:
+				throw_exception(EncodeException("blob payload was streamed to a handler"));
+			case ObjectType::Error:
+				throw_exception(EncodeException("invalid cbor object type"));
+		}
+	}
+	
+	auto Encoder::write_object(PObject value) -> void {
+		// iterative with a stack kept between calls, deeply nested trees do not grow the call stack
+		_stack.clear();
+		_order.clear();
+		auto item = value.get();
+		while(true) {
+			if(item != nullptr) {
+				write_node(*item);
 			}
-			case ObjectType::Map: {
-				auto const& map_value = value->as_map();
-				write_map(map_value.size());
-				for(auto const& p: map_value) {
-					write_string(p.first);
-					write_object(p.second);
-				}
+			if(_stack.empty()) {
 				return;
 			}
-			case ObjectType::Error: {
-				throw EncodeException("invalid cbor object type");
+			auto& frame = _stack.back();
+			if(frame.object->is_array()) {
+				auto const& array_value = frame.object->as_array();
+				item = array_value[frame.index].get();
+				if(++frame.index == array_value.size()) {
+					_stack.pop_back();
+				}
+			} else if(frame.object->is_tagged()) {
+				item = frame.object->tagged_item().get();
+				_stack.pop_back();
+			} else {
+				auto const& map_value = frame.object->as_map();
+				auto const& entry = _deterministic ? *_order[frame.order + frame.index] : *frame.it++;
+				write_string(entry.first.data(), (uint32_t)entry.first.size());
+				item = entry.second.get();
+				if(++frame.index == map_value.size()) {
+					if(_deterministic) {
+						_order.resize(frame.order);
+					}
+					_stack.pop_back();
+				}
+			}
+		}
+	}
+	
+	auto DeterministicOrder::append(MapValue const& map_value, std::vector<MapValue::value_type const*>& order) -> void {
+		// the head of a text string grows with its length, so encoded keys compare by length first;
+		// std::map already keeps keys of one length bytewise, a stable pass over lengths finishes the sort
+		auto begin = order.size();
+		_entries.clear();
+		size_t max_length = 0;
+		auto sorted = true;
+		for(auto const& entry: map_value) {
+			auto length = entry.first.size();
+			sorted = sorted && length >= max_length;
+			max_length = std::max(max_length, length);
+			_entries.push_back({length, &entry});
+		}
+		if(sorted || max_length > 4 * map_value.size() + 256) {
+			if(!sorted) {
+				std::stable_sort(_entries.begin(), _entries.end(), [](auto const& first, auto const& second) {
+					return first.first < second.first;
+				});
 			}
+			for(auto const& entry: _entries) {
+				order.push_back(entry.second);
+			}
+			return;
+		}
+		_length_counts.assign(max_length + 2, 0);
+		for(auto const& entry: _entries) {
+			++_length_counts[entry.first + 1];
+		}
+		for(size_t i = 1; i < _length_counts.size(); ++i) {
+			_length_counts[i] += _length_counts[i - 1];
+		}
+		order.resize(begin + _entries.size());
+		for(auto const& entry: _entries) {
+			order[begin + _length_counts[entry.first]++] = entry.second;
+		}
+	}
+	
+	auto deterministic_key_less(std::string const& first, std::string const& second) -> bool {
+		if(first.size() != second.size()) {
+			return first.size() < second.size();
+		}
+		return memcmp(first.data(), second.data(), first.size()) < 0;
+	}
+	
+	static auto head_size(uint64_t value) -> size_t {
+		if(value < 24ULL) {
+			return 1;
+		} else if(value < 256ULL) {
+			return 2;
+		} else if(value < 65536ULL) {
+			return 3;
+		} else if(value < 4294967296ULL) {
+			return 5;
+		}
+		return 9;
+	}
+	
+	/// Item left to measure with the size of the map key written before it.
+	struct MeasureItem {
+		Object const* node;
+		size_t prefix;
+	};
+	
+	/// Adds the encoded size of value to size, returns the error for objects write_object rejects.
+	/// Children are pushed in reverse, so on error size is the offset of the rejected object.
+	static auto measure(PObject const& value, size_t& size) -> ErrorCode {
+		thread_local std::vector<MeasureItem> stack;
+		stack.clear();
+		stack.push_back({value.get(), 0});
+		while(!stack.empty()) {
+			auto item = stack.back();
+			stack.pop_back();
+			size += item.prefix;
+			if(item.node == nullptr)
+				continue;
+			auto const& node = *item.node;
+			switch(node.object_type()) {
+				case ObjectType::Null:
+				case ObjectType::Undefined:
+				case ObjectType::Bool:
+					size += 1;
+					break;
+				case ObjectType::Int: {
+					auto int_value = node.as_int();
+					size += head_size(int_value < 0 ? (uint64_t)-(int_value + 1) : (uint64_t)int_value);
+					break;
+				}
+				case ObjectType::ExtraInt:
+					size += head_size(node.as<ObjectType::ExtraInt>().second);
+					break;
+				case ObjectType::String: {
+					auto string_size = node.as_string().size();
+					size += head_size(string_size) + string_size;
+					break;
+				}
+				case ObjectType::Bytes: {
+					auto bytes_size = node.as_bytes().size();
+					size += head_size(bytes_size) + bytes_size;
+					break;
+				}
+				case ObjectType::Tag:
+				case ObjectType::ExtraTag:
+					size += head_size(node.tag_number());
+					stack.push_back({node.tagged_item().get(), 0});
+					break;
+				case ObjectType::Special:
+					size += head_size(node.as_special());
+					break;
+				case ObjectType::ExtraSpecial:
+					size += head_size((uint32_t)node.as<ObjectType::ExtraSpecial>());
+					break;
+				case ObjectType::Array: {
+					auto const& array_value = node.as_array();
+					size += head_size(array_value.size());
+					for(auto it = array_value.rbegin(); it != array_value.rend(); ++it) {
+						stack.push_back({it->get(), 0});
+					}
+					break;
+				}
+				case ObjectType::Map: {
+					auto const& map_value = node.as_map();
+					size += head_size(map_value.size());
+					for(auto it = map_value.rbegin(); it != map_value.rend(); ++it) {
+						stack.push_back({it->second.get(), head_size(it->first.size()) + it->first.size()});
+					}
+					break;
+				}
+				case ObjectType::Native: {
+					OutputCounter counter;
+					Encoder encoder(counter);
+					node.as_native()->encode(encoder);
+					size += counter.size();
+					break;
+				}
+				case ObjectType::Blob:
+				case ObjectType::Error:
+					return ErrorCode::InvalidObject;
+			}
+		}
+		return ErrorCode::None;
+	}
+	
+	auto encoded_size(PObject const& value) -> size_t {
+		size_t size = 0;
+		if(measure(value, size) != ErrorCode::None) {
+			if(value && value->is_blob())
+				throw_exception(EncodeException("blob payload was streamed to a handler"));
+			throw_exception(EncodeException("invalid cbor object type"));
+		}
+		return size;
+	}
+	
+	auto try_encode(Output& output, PObject const& value) -> Error {
+		size_t size = 0;
+		auto code = measure(value, size);
+		if(code != ErrorCode::None) {
+			return {code, size};
+		}
+		if(size > output.remaining_capacity()) {
+			return {ErrorCode::Overflow, output.remaining_capacity()};
+		}
+#if CBOR_EXCEPTIONS
+		try {
+			Encoder(output).write_object(value);
+		} catch(std::bad_alloc const&) {
+			return {ErrorCode::OutOfMemory, output.size()};
 		}
+#else
+		Encoder(output).write_object(value);
+#endif
+		return {};
 	}
 }
@@ -18,19 +18,61 @@
 
 #include "../Output/Output.hpp"
 #include "../Object/Object.hpp"
+#include "../Error/Error.hpp"
 #include <string>
+#include <vector>
 #include <cstdint>
 
 namespace cbor {
+	/// Orders map entries by their encoded keys as deterministic encoding requires, keeps its buffers between maps.
+	class DeterministicOrder {
+	public:
+		/// Appends the entries of map_value to order, shorter keys first and equal lengths bytewise.
+		auto append(MapValue const& map_value, std::vector<MapValue::value_type const*>& order) -> void;
+	
+	private:
+		std::vector<std::pair<size_t, MapValue::value_type const*> > _entries;
+		std::vector<size_t> _length_counts;
+	};
+	
+	/// Encoder settings for functions that create their own encoders.
+	struct EncodeOptions {
+		bool validate_utf8 = false;
+		bool deterministic = false;
+	};
+	
 	class Encoder {
 	private:
+		/// Container of write_object whose items are not all written yet.
+		struct ObjectFrame {
+			Object const* object;
+			size_t index;
+			MapValue::const_iterator it;
+			size_t order;
+		};
+		
 		Output* _out;
+		bool _validate_utf8;
+		bool _deterministic;
+		std::vector<ObjectFrame> _stack;
+		std::vector<MapValue::value_type const*> _order;
+		DeterministicOrder _key_order;
 	
 	public:
 		Encoder(Output& out);
 		
 		~Encoder();
 		
+		/// Makes write_string and write_string_ref throw on data that is not valid UTF-8, off by default.
+		auto set_utf8_validation(bool enabled) -> void;
+		
+		/// Makes write_object write map keys in RFC 8949 deterministic order, off by default.
+		/// Heads are always the shortest form, maps written with write_map keep the order of the caller.
+		auto set_deterministic(bool enabled) -> void;
+		
+		/// Applies both settings at once.
+		auto set_options(EncodeOptions const& options) -> void;
+		
 		auto write_bool(bool value) -> void;
 		
 		auto write_int(int32_t value) -> void;
@@ -47,14 +89,23 @@ namespace cbor {
 		
 		auto write_string(const std::string str) -> void;
 		
+		/// Like write_bytes, but the data has to stay alive until the output is consumed.
+		auto write_bytes_ref(const uint8_t* data, uint32_t size) -> void;
+		
+		/// Like write_string, but the data has to stay alive until the output is consumed.
+		auto write_string_ref(const char* data, uint32_t size) -> void;
+		
 		auto write_array(int size) -> void;
 		
 		auto write_map(int size) -> void;
 		
-		auto write_tag(const uint32_t tag) -> void;
+		auto write_tag(uint64_t tag) -> void;
 		
 		auto write_special(int special) -> void;
 		
+		/// Writes the shortest of half, single and double precision that keeps value exactly, NaN as a half.
+		auto write_double(double value) -> void;
+		
 		auto write_null() -> void;
 		
 		auto write_undefined() -> void;
@@ -65,5 +116,20 @@ namespace cbor {
 		auto write_type_value(int major_type, uint32_t value) -> void;
 		
 		auto write_type_value(int major_type, uint64_t value) -> void;
+		
+		auto check_utf8(const char* data, size_t size) const -> void;
+		
+		/// Writes a leaf, or the head of a container and pushes its frame when it has items.
+		auto write_node(Object const& value) -> void;
 	};
+	
+	/// Order of map keys in deterministic encoding, for maps written by hand with write_map.
+	auto deterministic_key_less(std::string const& first, std::string const& second) -> bool;
+	
+	/// Exact number of bytes Encoder::write_object writes for value.
+	auto encoded_size(PObject const& value) -> size_t;
+	
+	/// Encodes value without throwing, fails before writing anything when it cannot be encoded or does not fit.
+	/// Running out of memory is reported as ErrorCode::OutOfMemory, builds without exceptions abort instead.
+	auto try_encode(Output& output, PObject const& value) -> Error;
 }
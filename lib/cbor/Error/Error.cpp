@@ -0,0 +1,33 @@
+#include "Error.hpp"
+
+namespace cbor {
+	auto error_message(ErrorCode code) -> const char* {
+		switch(code) {
+			case ErrorCode::None:
+				return "no error";
+			case ErrorCode::Empty:
+				return "cbor decoded nothing";
+			case ErrorCode::UnexpectedEnd:
+				return "unexpected end of input";
+			case ErrorCode::InvalidHead:
+				return "invalid additional info";
+			case ErrorCode::TooLong:
+				return "length is too large";
+			case ErrorCode::InvalidMapKey:
+				return "invalid map key type";
+			case ErrorCode::TrailingData:
+				return "multiple cbor object when decoding";
+			case ErrorCode::InvalidObject:
+				return "object cannot be encoded";
+			case ErrorCode::Overflow:
+				return "buffer overflow error";
+			case ErrorCode::LimitExceeded:
+				return "decode limit exceeded";
+			case ErrorCode::InvalidJson:
+				return "invalid json";
+			case ErrorCode::OutOfMemory:
+				return "out of memory";
+		}
+		return "unknown error";
+	}
+}
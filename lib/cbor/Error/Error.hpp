@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cbor {
+	enum class ErrorCode : uint8_t {
+		None,
+		Empty,
+		UnexpectedEnd,
+		InvalidHead,
+		TooLong,
+		InvalidMapKey,
+		TrailingData,
+		InvalidObject,
+		Overflow,
+		LimitExceeded,
+		InvalidJson,
+		OutOfMemory,
+	};
+	
+	/// Result of the non-throwing API, offset is the position of the offending byte.
+	struct Error {
+		ErrorCode code = ErrorCode::None;
+		size_t offset = 0;
+		
+		explicit operator bool() const {
+			return code != ErrorCode::None;
+		}
+	};
+	
+	auto error_message(ErrorCode code) -> const char*;
+}
@@ -5,8 +5,27 @@
 #include <memory>
 #include <cstdint>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define CBOR_EXCEPTIONS 1
+#else
+#define CBOR_EXCEPTIONS 0
+#endif
 
 namespace cbor {
+	/// Throws exception, or prints it and aborts when built with -fno-exceptions.
+	template<typename Exception_>
+	[[noreturn]] auto throw_exception(Exception_ const& exception) -> void {
+#if CBOR_EXCEPTIONS
+		throw exception;
+#else
+		fprintf(stderr, "cbor: %s\n", exception.what());
+		abort();
+#endif
+	}
+	
 	constexpr auto default_exception_code = 1;
 	
 	class Exception : public std::exception {
@@ -49,12 +68,9 @@ namespace cbor {
 			return std::make_shared<Exception>(*this);
 		}
 		
+		/// Rethrows as the most derived exception type whose code matches, as Exception otherwise.
 		inline virtual auto dynamic_rethrow_exception() const -> void {
-			if(code() == 0) {
-				throw *this;
-			} else {
-				Exception::dynamic_rethrow_exception();
-			}
+			throw_exception(*this);
 		}
 		
 		inline auto operator=(const Exception& other) -> Exception& {
@@ -88,7 +104,7 @@ namespace cbor {
 		
 		virtual auto dynamic_rethrow_exception() const -> void {
 			if(this->code() == Code_) {
-				throw *this;
+				throw_exception(*this);
 			} else {
 				cbor::Exception::dynamic_rethrow_exception();
 			}
@@ -0,0 +1,84 @@
+#include "FrameSplitter.hpp"
+#include "../Crc32c/Crc32c.hpp"
+#include "../Exceptions/Exceptions.hpp"
+
+#include <algorithm>
+
+namespace cbor {
+	static constexpr size_t frame_prefix_size = 4;
+	
+	FrameSplitter::FrameSplitter(bool checksum, size_t max_frame_size) :
+		_checksum(checksum), _max_frame_size(max_frame_size), _data(nullptr), _size(0), _pending_returned(false) {
+	}
+	
+	auto FrameSplitter::feed(const uint8_t* data, size_t size) -> void {
+		if(_size > 0) {
+			throw_exception(DecodeException("previous input is not consumed"));
+		}
+		_data = data;
+		_size = size;
+	}
+	
+	auto FrameSplitter::frame_size(const uint8_t* prefix) const -> size_t {
+		size_t length = ((size_t)prefix[0] << 24) | ((size_t)prefix[1] << 16) | ((size_t)prefix[2] << 8) | (size_t)prefix[3];
+		if(length > _max_frame_size) {
+			throw_exception(DecodeException("frame too large"));
+		}
+		return frame_prefix_size + length + (_checksum ? 4 : 0);
+	}
+	
+	auto FrameSplitter::check(Frame const& frame, const uint8_t* crc) const -> void {
+		if(!_checksum) {
+			return;
+		}
+		uint32_t expected = ((uint32_t)crc[0] << 24) | ((uint32_t)crc[1] << 16) | ((uint32_t)crc[2] << 8) | (uint32_t)crc[3];
+		if(crc32c(0, frame.data, frame.size) != expected) {
+			throw_exception(DecodeException("frame checksum mismatch"));
+		}
+	}
+	
+	auto FrameSplitter::next(Frame& frame) -> bool {
+		if(_pending_returned) {
+			_pending.clear();
+			_pending_returned = false;
+		}
+		if(!_pending.empty()) {
+			// complete a frame that was split across feeds
+			auto take = [&](size_t count) {
+				auto size = std::min(count, _size);
+				_pending.insert(_pending.end(), _data, _data + size);
+				_data += size;
+				_size -= size;
+			};
+			if(_pending.size() < frame_prefix_size) {
+				take(frame_prefix_size - _pending.size());
+				if(_pending.size() < frame_prefix_size) {
+					return false;
+				}
+			}
+			auto total = frame_size(_pending.data());
+			take(total - _pending.size());
+			if(_pending.size() < total) {
+				return false;
+			}
+			frame = {_pending.data() + frame_prefix_size, total - frame_prefix_size - (_checksum ? 4 : 0)};
+			check(frame, _pending.data() + total - 4);
+			_pending_returned = true;
+			return true;
+		}
+		if(_size >= frame_prefix_size) {
+			auto total = frame_size(_data);
+			if(_size >= total) {
+				frame = {_data + frame_prefix_size, total - frame_prefix_size - (_checksum ? 4 : 0)};
+				check(frame, _data + total - 4);
+				_data += total;
+				_size -= total;
+				return true;
+			}
+		}
+		_pending.assign(_data, _data + _size);
+		_data = nullptr;
+		_size = 0;
+		return false;
+	}
+}
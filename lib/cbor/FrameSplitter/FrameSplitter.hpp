@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace cbor {
+	struct Frame {
+		const uint8_t* data;
+		size_t size;
+	};
+	
+	/// Splits a received byte stream into the frames written by FrameWriter.
+	/// Frames that arrive whole point into the fed memory, only frames split across feeds are copied.
+	class FrameSplitter {
+	public:
+		FrameSplitter(bool checksum = true, size_t max_frame_size = (size_t)16 << 20);
+		
+		/// Adds received bytes, they have to stay valid until next() returns false.
+		auto feed(const uint8_t* data, size_t size) -> void;
+		
+		/// Returns the next complete payload, valid until the next call, throws DecodeException on a bad checksum.
+		auto next(Frame& frame) -> bool;
+	
+	private:
+		auto frame_size(const uint8_t* prefix) const -> size_t;
+		
+		auto check(Frame const& frame, const uint8_t* crc) const -> void;
+		
+		bool _checksum;
+		size_t _max_frame_size;
+		const uint8_t* _data;
+		size_t _size;
+		std::vector<uint8_t> _pending;
+		bool _pending_returned;
+	};
+}
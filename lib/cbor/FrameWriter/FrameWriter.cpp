@@ -0,0 +1,120 @@
+#include "FrameWriter.hpp"
+#include "../Crc32c/Crc32c.hpp"
+#include "../Exceptions/Exceptions.hpp"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <limits.h>
+
+namespace cbor {
+	static constexpr size_t frame_prefix_size = 4;
+	
+	FrameWriter::FrameWriter(bool checksum, size_t flush_threshold, Allocator& allocator) :
+		_batch(allocator), _checksum(checksum), _flush_threshold(flush_threshold), _open(false),
+		_frame_start(0), _checksum_offset(0), _crc(0), _frame_count(0), _flushed(0) {
+	}
+	
+	auto FrameWriter::begin_frame() -> void {
+		if(_open) {
+			throw_exception(OutputException("frame already open"));
+		}
+		_open = true;
+		_frame_start = _batch.size();
+		const unsigned char prefix[frame_prefix_size] = {};
+		_batch.put_bytes(prefix, frame_prefix_size);
+		_checksum_offset = _batch.size();
+		_crc = 0;
+	}
+	
+	auto FrameWriter::update_checksum() -> void {
+		if(_checksum && _checksum_offset < _batch.size()) {
+			_crc = crc32c(_crc, _batch.data() + _checksum_offset, _batch.size() - _checksum_offset);
+			_checksum_offset = _batch.size();
+		}
+	}
+	
+	auto FrameWriter::end_frame() -> void {
+		if(!_open) {
+			throw_exception(OutputException("no open frame"));
+		}
+		update_checksum();
+		auto length = _batch.size() - _frame_start - frame_prefix_size;
+		if(length > UINT32_MAX) {
+			throw_exception(OutputException("frame too large"));
+		}
+		auto prefix = _batch.data() + _frame_start;
+		prefix[0] = (unsigned char)(length >> 24);
+		prefix[1] = (unsigned char)(length >> 16);
+		prefix[2] = (unsigned char)(length >> 8);
+		prefix[3] = (unsigned char)length;
+		if(_checksum) {
+			const unsigned char crc[4] = {
+				(unsigned char)(_crc >> 24), (unsigned char)(_crc >> 16), (unsigned char)(_crc >> 8), (unsigned char)_crc
+			};
+			_batch.put_bytes(crc, sizeof(crc));
+		}
+		_open = false;
+		++_frame_count;
+	}
+	
+	auto FrameWriter::data() const -> unsigned char* {
+		return _batch.data();
+	}
+	
+	auto FrameWriter::size() const -> size_t {
+		return _open ? _frame_start : _batch.size();
+	}
+	
+	auto FrameWriter::put_byte(unsigned char value) -> void {
+		if(!_open) {
+			throw_exception(OutputException("no open frame"));
+		}
+		_batch.put_byte(value);
+	}
+	
+	auto FrameWriter::put_bytes(const unsigned char* data, size_t size) -> void {
+		if(!_open) {
+			throw_exception(OutputException("no open frame"));
+		}
+		_batch.put_bytes(data, size);
+		update_checksum();
+	}
+	
+	auto FrameWriter::frame_count() const -> size_t {
+		return _frame_count;
+	}
+	
+	auto FrameWriter::should_flush() const -> bool {
+		return _batch.size() >= _flush_threshold;
+	}
+	
+	auto FrameWriter::flush_to_fd(int fd) -> bool {
+		if(_open) {
+			throw_exception(OutputException("cannot flush inside a frame"));
+		}
+		// the batch is contiguous, so one write does what writev would do with a single buffer
+		while(_flushed < _batch.size()) {
+			auto result = ::write(fd, _batch.data() + _flushed, _batch.size() - _flushed);
+			if(result < 0) {
+				if(errno == EINTR) {
+					continue;
+				}
+				if(errno == EAGAIN || errno == EWOULDBLOCK) {
+					return false;
+				}
+				throw_exception(OutputException(std::string("write failed: ") + strerror(errno)));
+			}
+			_flushed += (size_t)result;
+		}
+		reset();
+		return true;
+	}
+	
+	auto FrameWriter::reset() -> void {
+		_batch.reset();
+		_open = false;
+		_frame_count = 0;
+		_flushed = 0;
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../OutputDynamic/OutputDynamic.hpp"
+
+namespace cbor {
+	/// Output collecting length-prefixed frames into one batch: a 4-byte big-endian payload length,
+	/// the payload and, with checksums on, the big-endian CRC32C of the payload.
+	/// The checksum is folded in on every put_bytes while the bytes are still in cache.
+	class FrameWriter : public Output {
+	public:
+		FrameWriter(bool checksum = true, size_t flush_threshold = 65536, Allocator& allocator = Allocator::standard());
+		
+		auto begin_frame() -> void;
+		
+		auto end_frame() -> void;
+		
+		/// Batched bytes of all finished frames.
+		auto data() const -> unsigned char* override;
+		
+		auto size() const -> size_t override;
+		
+		auto put_byte(unsigned char value) -> void override;
+		
+		auto put_bytes(const unsigned char* data, size_t size) -> void override;
+		
+		auto frame_count() const -> size_t;
+		
+		/// Whether the batch reached the flush threshold.
+		auto should_flush() const -> bool;
+		
+		/// Writes all finished frames to fd and clears the batch, returns false if a non-blocking fd would block.
+		/// The bytes already written are remembered, the next call continues after them.
+		auto flush_to_fd(int fd) -> bool;
+		
+		auto reset() -> void;
+	
+	private:
+		auto update_checksum() -> void;
+		
+		OutputDynamic _batch;
+		bool _checksum;
+		size_t _flush_threshold;
+		bool _open;
+		size_t _frame_start;
+		size_t _checksum_offset;
+		uint32_t _crc;
+		size_t _frame_count;
+		size_t _flushed;
+	};
+}
@@ -0,0 +1,522 @@
+#include "Hash.hpp"
+#include "../Encoder/Encoder.hpp"
+#include "../OutputDynamic/OutputDynamic.hpp"
+
+#include <string.h>
+#include <limits.h>
+
+namespace cbor {
+	enum class HashKind : uint64_t {
+		Absent = 1,
+		Unsigned,
+		Negative,
+		Bytes,
+		String,
+		Array,
+		Map,
+		Tag,
+		Special,
+		Bool,
+		Null,
+		Undefined,
+		Blob,
+		Error,
+	};
+	
+	static constexpr uint64_t k0 = 0x9e3779b97f4a7c15ull;
+	static constexpr uint64_t k1 = 0xbf58476d1ce4e5b9ull;
+	static constexpr uint64_t k2 = 0x94d049bb133111ebull;
+	
+	static auto mix(uint64_t value) -> uint64_t {
+		value ^= value >> 30;
+		value *= k1;
+		value ^= value >> 27;
+		value *= k2;
+		value ^= value >> 31;
+		return value;
+	}
+	
+	static auto combine(uint64_t seed, uint64_t value) -> uint64_t {
+		return mix(seed ^ (value + k0 + (seed << 6) + (seed >> 2)));
+	}
+	
+	static auto combine(HashKind kind, uint64_t value) -> uint64_t {
+		return combine((uint64_t)kind, value);
+	}
+	
+	static auto hash_bytes(HashKind kind, const void* data, size_t size) -> uint64_t {
+		auto bytes = (const uint8_t*)data;
+		auto result = (uint64_t)kind ^ (size * k0);
+		while(size >= 8) {
+			uint64_t word;
+			memcpy(&word, bytes, 8);
+			result = (result ^ word) * k1;
+			result ^= result >> 32;
+			bytes += 8;
+			size -= 8;
+		}
+		uint64_t word = 0;
+		memcpy(&word, bytes, size);
+		result = (result ^ word) * k2;
+		return mix(result);
+	}
+	
+	static auto hash_entry(uint64_t key, uint64_t value) -> uint64_t {
+		return combine(key, value);
+	}
+	
+	static auto finish_map(uint64_t size, uint64_t entries) -> uint64_t {
+		return combine(combine(HashKind::Map, size), entries);
+	}
+	
+	/// Integers as the major type and argument they are encoded with.
+	static auto hash_int(bool negative, uint64_t argument) -> uint64_t {
+		return combine(negative ? HashKind::Negative : HashKind::Unsigned, argument);
+	}
+	
+	/// Replaces the contents of output by the encoding of a native value.
+	static auto encode_native(Object const& value, OutputDynamic& output) -> void {
+		output.reset();
+		Encoder encoder(output);
+		value.as_native()->encode(encoder);
+	}
+	
+	/// Hash of everything but containers, which hash_tree folds from their children.
+	static auto hash_leaf(Object const& value) -> uint64_t {
+		switch(value.object_type()) {
+			case ObjectType::Bool:
+				return combine(HashKind::Bool, value.as_bool());
+			case ObjectType::Int: {
+				auto int_value = value.as_int();
+				return int_value < 0 ? hash_int(true, (uint64_t)(-1 - int_value)) : hash_int(false, (uint64_t)int_value);
+			}
+			case ObjectType::ExtraInt: {
+				auto const& extra = value.as<ObjectType::ExtraInt>();
+				// decoded negative values keep the argument plus one
+				return extra.first ? hash_int(false, extra.second) : hash_int(true, extra.second - 1);
+			}
+			case ObjectType::Bytes: {
+				auto const& bytes_value = value.as_bytes();
+				return hash_bytes(HashKind::Bytes, bytes_value.data(), bytes_value.size());
+			}
+			case ObjectType::String: {
+				auto const& string_value = value.as_string();
+				return hash_bytes(HashKind::String, string_value.data(), string_value.size());
+			}
+			case ObjectType::Special:
+				return combine(HashKind::Special, value.as_special());
+			case ObjectType::ExtraSpecial:
+				return combine(HashKind::Special, value.as<ObjectType::ExtraSpecial>());
+			case ObjectType::Null:
+				return mix((uint64_t)HashKind::Null);
+			case ObjectType::Undefined:
+				return mix((uint64_t)HashKind::Undefined);
+			case ObjectType::Blob: {
+				auto const& blob = value.as<ObjectType::Blob>();
+				return combine(combine(HashKind::Blob, blob.size), blob.handle);
+			}
+			case ObjectType::Error: {
+				auto const& error = value.as<ObjectType::Error>();
+				return hash_bytes(HashKind::Error, error.data(), error.size());
+			}
+			case ObjectType::Native: {
+				// hashes like the tree its encoding decodes to without a tag registry
+				thread_local OutputDynamic encoding;
+				encode_native(value, encoding);
+				uint64_t result = 0;
+				hash_encoded(encoding.data(), encoding.size(), result);
+				return result;
+			}
+			default:
+				return 0;
+		}
+	}
+	
+	/// Arrays, maps and tags, a tag hashes like a one-item array seeded with its number.
+	static auto is_container(Object const& value) -> bool {
+		return value.is_array() || value.is_map() || value.is_tagged();
+	}
+	
+	struct HashFrame {
+		Object const* node;
+		PObject const* owner;
+		size_t index;
+		MapValue::const_iterator it;
+		uint64_t hash;
+	};
+	
+	/// Hashes a container with an explicit stack so the depth of the tree is not limited by the call stack.
+	/// known may supply the hash of a child container, store receives every container hashed with its owner.
+	template<typename Known_, typename Store_>
+	static auto hash_tree(Object const& root, PObject const* root_owner, Known_&& known, Store_&& store) -> uint64_t {
+		thread_local std::vector<HashFrame> stack;
+		stack.clear();
+		auto open = [](Object const& node, PObject const* owner) -> HashFrame {
+			if(node.is_array()) {
+				return {&node, owner, 0, {}, combine(HashKind::Array, node.as_array().size())};
+			}
+			if(node.is_tagged()) {
+				return {&node, owner, 0, {}, combine(HashKind::Tag, node.tag_number())};
+			}
+			return {&node, owner, 0, node.as_map().begin(), 0};
+		};
+		stack.push_back(open(root, root_owner));
+		while(true) {
+			auto& frame = stack.back();
+			PObject const* child = nullptr;
+			if(frame.node->is_array()) {
+				auto const& array_value = frame.node->as_array();
+				if(frame.index < array_value.size()) {
+					child = &array_value[frame.index];
+				}
+			} else if(frame.node->is_tagged()) {
+				if(frame.index == 0) {
+					child = &frame.node->tagged_item();
+				}
+			} else if(frame.it != frame.node->as_map().end()) {
+				child = &frame.it->second;
+			}
+			
+			uint64_t item;
+			if(child == nullptr) {
+				item = frame.node->is_map() ? finish_map(frame.node->as_map().size(), frame.hash) : frame.hash;
+				store(frame.owner, item);
+				stack.pop_back();
+				if(stack.empty()) {
+					return item;
+				}
+			} else if(!*child) {
+				item = mix((uint64_t)HashKind::Absent);
+			} else if(!is_container(**child)) {
+				item = hash_leaf(**child);
+			} else if(!known(*child, item)) {
+				stack.push_back(open(**child, child));
+				continue;
+			}
+			
+			// folds the finished child into its parent and moves to the next one
+			auto& parent = stack.back();
+			if(!parent.node->is_map()) {
+				parent.hash = combine(parent.hash, item);
+				++parent.index;
+			} else {
+				auto const& key = parent.it->first;
+				parent.hash += hash_entry(hash_bytes(HashKind::String, key.data(), key.size()), item);
+				++parent.it;
+			}
+		}
+	}
+	
+	auto hash(Object const& value) -> uint64_t {
+		if(!is_container(value)) {
+			return hash_leaf(value);
+		}
+		return hash_tree(value, nullptr, [](PObject const&, uint64_t&) {
+			return false;
+		}, [](PObject const*, uint64_t) {
+		});
+	}
+	
+	/// Integer value of the kinds that hash by value, returns false for the others.
+	static auto number(Object const& value, HashKind& kind, uint64_t& result) -> bool {
+		switch(value.object_type()) {
+			case ObjectType::Int: {
+				auto int_value = value.as_int();
+				kind = int_value < 0 ? HashKind::Negative : HashKind::Unsigned;
+				result = int_value < 0 ? (uint64_t)(-1 - int_value) : (uint64_t)int_value;
+				return true;
+			}
+			case ObjectType::ExtraInt: {
+				auto const& extra = value.as<ObjectType::ExtraInt>();
+				kind = extra.first ? HashKind::Unsigned : HashKind::Negative;
+				result = extra.first ? extra.second : extra.second - 1;
+				return true;
+			}
+			case ObjectType::Special:
+			case ObjectType::ExtraSpecial:
+				kind = HashKind::Special;
+				result = value.is<ObjectType::Special>() ? value.as_special() : value.as<ObjectType::ExtraSpecial>();
+				return true;
+			default:
+				return false;
+		}
+	}
+	
+	/// Compares everything but the children of containers.
+	static auto equal_node(Object const& first, Object const& second) -> bool {
+		if(first.is_tagged() || second.is_tagged()) {
+			return first.is_tagged() && second.is_tagged() && first.tag_number() == second.tag_number();
+		}
+		HashKind first_kind;
+		HashKind second_kind;
+		uint64_t first_number;
+		uint64_t second_number;
+		if(number(first, first_kind, first_number)) {
+			return number(second, second_kind, second_number) && first_kind == second_kind && first_number == second_number;
+		}
+		if(first.object_type() != second.object_type()) {
+			return false;
+		}
+		switch(first.object_type()) {
+			case ObjectType::Array:
+				return first.as_array().size() == second.as_array().size();
+			case ObjectType::Map:
+				return first.as_map().size() == second.as_map().size();
+			case ObjectType::Blob: {
+				auto const& first_blob = first.as<ObjectType::Blob>();
+				auto const& second_blob = second.as<ObjectType::Blob>();
+				return first_blob.handle == second_blob.handle && first_blob.size == second_blob.size;
+			}
+			case ObjectType::Bool:
+				return first.as_bool() == second.as_bool();
+			case ObjectType::Bytes:
+				return first.as_bytes() == second.as_bytes();
+			case ObjectType::String:
+				return first.as_string() == second.as_string();
+			case ObjectType::Error:
+				return first.as<ObjectType::Error>() == second.as<ObjectType::Error>();
+			case ObjectType::Native: {
+				thread_local OutputDynamic first_encoding;
+				thread_local OutputDynamic second_encoding;
+				encode_native(first, first_encoding);
+				encode_native(second, second_encoding);
+				return first_encoding.size() == second_encoding.size() &&
+					memcmp(first_encoding.data(), second_encoding.data(), first_encoding.size()) == 0;
+			}
+			default:
+				// null and undefined, numbers were compared above
+				return true;
+		}
+	}
+	
+	struct EqualFrame {
+		Object const* first;
+		Object const* second;
+		size_t index;
+		MapValue::const_iterator first_it;
+		MapValue::const_iterator second_it;
+	};
+	
+	static auto open_equal(Object const& first, Object const& second) -> EqualFrame {
+		if(!first.is_map()) {
+			return {&first, &second, 0, {}, {}};
+		}
+		return {&first, &second, 0, first.as_map().begin(), second.as_map().begin()};
+	}
+	
+	auto equal(Object const& first, Object const& second) -> bool {
+		if(!equal_node(first, second)) {
+			return false;
+		}
+		if(!is_container(first)) {
+			return true;
+		}
+		thread_local std::vector<EqualFrame> stack;
+		stack.clear();
+		stack.push_back(open_equal(first, second));
+		while(!stack.empty()) {
+			auto& frame = stack.back();
+			PObject const* first_child;
+			PObject const* second_child;
+			if(frame.first->is_tagged()) {
+				if(frame.index == 1) {
+					stack.pop_back();
+					continue;
+				}
+				first_child = &frame.first->tagged_item();
+				second_child = &frame.second->tagged_item();
+				++frame.index;
+			} else if(frame.first->is_array()) {
+				auto const& first_array = frame.first->as_array();
+				if(frame.index == first_array.size()) {
+					stack.pop_back();
+					continue;
+				}
+				first_child = &first_array[frame.index];
+				second_child = &frame.second->as_array()[frame.index];
+				++frame.index;
+			} else {
+				// std::map keeps both in key order, so entries are compared pairwise
+				if(frame.first_it == frame.first->as_map().end()) {
+					stack.pop_back();
+					continue;
+				}
+				if(frame.first_it->first != frame.second_it->first) {
+					return false;
+				}
+				first_child = &frame.first_it->second;
+				second_child = &frame.second_it->second;
+				++frame.first_it;
+				++frame.second_it;
+			}
+			
+			if(!*first_child || !*second_child) {
+				if(*first_child || *second_child) {
+					return false;
+				}
+				continue;
+			}
+			if(*first_child == *second_child) {
+				continue;
+			}
+			if(!equal_node(**first_child, **second_child)) {
+				return false;
+			}
+			if(is_container(**first_child)) {
+				stack.push_back(open_equal(**first_child, **second_child));
+			}
+		}
+		return true;
+	}
+	
+	auto hash_encoded(const void* data, size_t size, uint64_t& result) -> Error {
+		struct Frame {
+			uint64_t remaining;
+			uint64_t size;
+			uint64_t hash;
+			uint64_t key;
+			bool is_map;
+			bool at_key;
+		};
+		
+		auto bytes = (const uint8_t*)data;
+		if(size == 0) {
+			return {ErrorCode::Empty, 0};
+		}
+		thread_local std::vector<Frame> stack;
+		stack.clear();
+		size_t offset = 0;
+		while(true) {
+			if(offset >= size) {
+				return {ErrorCode::UnexpectedEnd, offset};
+			}
+			auto start = offset;
+			uint8_t major_type = bytes[offset] >> 5;
+			uint8_t minor_type = bytes[offset] & 0b00011111;
+			++offset;
+			uint64_t value = minor_type;
+			if(minor_type >= 28) {
+				return {ErrorCode::InvalidHead, start};
+			}
+			if(minor_type >= 24) {
+				size_t width = (size_t)1 << (minor_type - 24);
+				if(size - offset < width) {
+					return {ErrorCode::UnexpectedEnd, size};
+				}
+				value = 0;
+				for(size_t i = 0; i < width; ++i) {
+					value = (value << 8) | bytes[offset++];
+				}
+			}
+			if(!stack.empty() && stack.back().is_map && stack.back().at_key && major_type != 3) {
+				return {ErrorCode::InvalidMapKey, start};
+			}
+			
+			uint64_t item;
+			switch(major_type) {
+				case 0:
+				case 1:
+					item = hash_int(major_type == 1, value);
+					break;
+				case 2:
+				case 3:
+					if(minor_type == 27 || value > INT_MAX) {
+						return {ErrorCode::TooLong, start};
+					}
+					if(size - offset < value) {
+						return {ErrorCode::UnexpectedEnd, size};
+					}
+					item = hash_bytes(major_type == 2 ? HashKind::Bytes : HashKind::String, bytes + offset, value);
+					offset += value;
+					break;
+				case 4:
+				case 5:
+					if(minor_type == 27) {
+						return {ErrorCode::TooLong, start};
+					}
+					if(value > 0) {
+						auto is_map = major_type == 5;
+						stack.push_back({is_map ? value * 2 : value, value, is_map ? 0 : combine(HashKind::Array, value), 0, is_map, true});
+						continue;
+					}
+					item = major_type == 5 ? finish_map(0, 0) : combine(HashKind::Array, 0);
+					break;
+				case 6:
+					// a prefix of the next item, hashed like a one-item array seeded with the tag number
+					stack.push_back({1, 1, combine(HashKind::Tag, value), 0, false, true});
+					continue;
+				default:
+					if(minor_type == 20 || minor_type == 21) {
+						item = combine(HashKind::Bool, minor_type == 21);
+					} else if(minor_type == 22) {
+						item = mix((uint64_t)HashKind::Null);
+					} else if(minor_type == 23) {
+						item = mix((uint64_t)HashKind::Undefined);
+					} else {
+						item = combine(HashKind::Special, value);
+					}
+					break;
+			}
+			
+			// folds the finished item into its parents, closing every container it completes
+			while(true) {
+				if(stack.empty()) {
+					if(offset < size) {
+						return {ErrorCode::TrailingData, offset};
+					}
+					result = item;
+					return {};
+				}
+				auto& frame = stack.back();
+				if(!frame.is_map) {
+					frame.hash = combine(frame.hash, item);
+				} else if(frame.at_key) {
+					frame.key = item;
+				} else {
+					frame.hash += hash_entry(frame.key, item);
+				}
+				frame.at_key = !frame.at_key;
+				if(--frame.remaining > 0) {
+					break;
+				}
+				item = frame.is_map ? finish_map(frame.size, frame.hash) : frame.hash;
+				stack.pop_back();
+			}
+		}
+	}
+	
+	auto HashCache::hash_node(PObject const& value) -> uint64_t {
+		if(!value) {
+			return mix((uint64_t)HashKind::Absent);
+		}
+		if(!is_container(*value)) {
+			return hash_leaf(*value);
+		}
+		auto found = _hashes.find(value.get());
+		if(found != _hashes.end()) {
+			return found->second.second;
+		}
+		return hash_tree(*value, &value, [this](PObject const& item, uint64_t& result) {
+			auto cached = _hashes.find(item.get());
+			if(cached == _hashes.end()) {
+				return false;
+			}
+			result = cached->second.second;
+			return true;
+		}, [this](PObject const* owner, uint64_t result) {
+			_hashes.emplace(owner->get(), std::make_pair(*owner, result));
+		});
+	}
+	
+	auto HashCache::hash(PObject const& value) -> uint64_t {
+		return hash_node(value);
+	}
+	
+	auto HashCache::size() const -> size_t {
+		return _hashes.size();
+	}
+	
+	auto HashCache::clear() -> void {
+		_hashes.clear();
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../Object/Object.hpp"
+#include "../Error/Error.hpp"
+#include <unordered_map>
+
+namespace cbor {
+	/// Structural hash: map entries are combined order-insensitively and integers, tags and specials
+	/// hash by value whatever width they were encoded with. Stable within one platform.
+	auto hash(Object const& value) -> uint64_t;
+	
+	/// Structural equality with the same rules as hash, native values are equal to native values with the same encoding.
+	auto equal(Object const& first, Object const& second) -> bool;
+	
+	/// Hash of the tree a document decodes to without building it, equal to hash of the decoded tree
+	/// for any order of map entries. Documents with repeated map keys hash differently from their tree.
+	auto hash_encoded(const void* data, size_t size, uint64_t& result) -> Error;
+	
+	/// Remembers hashes of containers by node, the cached nodes are kept alive and must not be modified.
+	class HashCache {
+	public:
+		auto hash(PObject const& value) -> uint64_t;
+		
+		auto size() const -> size_t;
+		
+		auto clear() -> void;
+	
+	private:
+		auto hash_node(PObject const& value) -> uint64_t;
+		
+		std::unordered_map<Object const*, std::pair<PObject, uint64_t>> _hashes;
+	};
+}
@@ -15,6 +15,7 @@
 */
 
 #include "Input.hpp"
+#include "../Exceptions/Exceptions.hpp"
 
 #include <stdlib.h>
 #include <string.h>
@@ -25,7 +26,15 @@ namespace cbor {
 	}
 	
 	auto Input::has_bytes(int count) -> bool {
-		return _size - _offset >= count;
+		return _size - _offset >= count || fill(count);
+	}
+	
+	auto Input::fill(int) -> bool {
+		return false;
+	}
+	
+	auto Input::read_direct(void*, int) -> void {
+		throw_exception(DecodeException("unexpected end of input"));
 	}
 	
 	auto Input::get_int8() -> uint8_t {
@@ -60,14 +69,39 @@ namespace cbor {
 	}
 	
 	auto Input::get_bytes(void* to, int count) -> void {
-		memcpy(to, _data + _offset, count);
-		_offset += count;
+		if(count <= _size - _offset) {
+			memcpy(to, _data + _offset, count);
+			_offset += count;
+		} else {
+			auto buffered = _size - _offset;
+			memcpy(to, _data + _offset, buffered);
+			_offset = _size;
+			read_direct((uint8_t*)to + buffered, count - buffered);
+		}
+	}
+	
+	auto Input::skip(int count) -> void {
+		if(count <= _size - _offset) {
+			_offset += count;
+		} else {
+			auto buffered = _size - _offset;
+			_offset = _size;
+			read_direct(nullptr, count - buffered);
+		}
 	}
 	
 	Input::~Input() {
 	}
 	
 	auto Input::is_empty() -> bool {
-		return _size == _offset;
+		return !has_bytes(1);
+	}
+	
+	auto Input::offset() const -> int {
+		return _offset;
+	}
+	
+	auto Input::buffered() const -> int {
+		return _size - _offset;
 	}
 }
@@ -20,10 +20,16 @@
 
 namespace cbor {
 	class Input {
-	private:
+	protected:
 		uint8_t* _data;
 		int _size;
 		int _offset;
+		
+		/// Called when fewer than count bytes are buffered, refillable inputs load more and return whether count bytes are available.
+		virtual auto fill(int count) -> bool;
+		
+		/// Reads count bytes past the buffered ones straight into to, or drops them when to is nullptr.
+		virtual auto read_direct(void* to, int count) -> void;
 	
 	public:
 		Input(void* data, int size);
@@ -32,6 +38,12 @@ namespace cbor {
 		
 		auto is_empty() -> bool;
 		
+		/// Position of the next byte in the current buffer.
+		auto offset() const -> int;
+		
+		/// Bytes available without refilling, all of the remaining input for a contiguous Input.
+		auto buffered() const -> int;
+		
 		auto get_int8() -> uint8_t;
 		
 		auto get_int16() -> uint16_t;
@@ -42,7 +54,8 @@ namespace cbor {
 		
 		auto get_bytes(void* to, int count) -> void;
 		
-		~Input();
+		auto skip(int count) -> void;
+		
+		virtual ~Input();
 	};
 }
-
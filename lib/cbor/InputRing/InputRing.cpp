@@ -0,0 +1,57 @@
+#include "InputRing.hpp"
+#include "../Exceptions/Exceptions.hpp"
+
+#include <string.h>
+#include <algorithm>
+
+namespace cbor {
+	InputRing::InputRing(RingBuffer& ring) :
+		Input(ring.data(), 0), _ring(&ring), _ring_data(ring.data()), _mask(ring.capacity - 1),
+		_window_start(ring.head.load(std::memory_order_relaxed)) {
+		_data = _ring_data + (_window_start & _mask);
+	}
+	
+	auto InputRing::release() -> void {
+		_ring->head.store(_window_start + _offset, std::memory_order_release);
+	}
+	
+	auto InputRing::set_window(uint64_t position, uint64_t available) -> void {
+		auto index = position & _mask;
+		_window_start = position;
+		_data = _ring_data + index;
+		_size = (int)std::min<uint64_t>(available, _ring->capacity - index);
+		_offset = 0;
+	}
+	
+	auto InputRing::fill(int count) -> bool {
+		auto position = _window_start + _offset;
+		_ring->head.store(position, std::memory_order_release);
+		auto available = _ring->tail.load(std::memory_order_acquire) - position;
+		set_window(position, available);
+		if(available < (uint64_t)count) {
+			return false;
+		}
+		if(_size < count && count <= (int)sizeof(_scratch)) {
+			// a short read straddles the end of the ring, serve it from a contiguous copy
+			memcpy(_scratch, _data, _size);
+			memcpy(_scratch + _size, _ring_data, count - _size);
+			_data = _scratch;
+			_size = count;
+		}
+		return true;
+	}
+	
+	auto InputRing::read_direct(void* to, int count) -> void {
+		auto position = _window_start + _offset;
+		if(_ring->tail.load(std::memory_order_acquire) - position < (uint64_t)count) {
+			throw_exception(DecodeException("unexpected end of input"));
+		}
+		if(to != nullptr) {
+			auto index = position & _mask;
+			auto first = std::min<uint64_t>(count, _ring->capacity - index);
+			memcpy(to, _ring_data + index, first);
+			memcpy((uint8_t*)to + first, _ring_data, count - first);
+		}
+		set_window(position + count, 0);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "../Input/Input.hpp"
+#include "../RingBuffer/RingBuffer.hpp"
+
+namespace cbor {
+	/// Consumer end of a RingBuffer, reads committed bytes in place and never blocks.
+	/// Since the producer commits whole items, Decoder::next() returns nullptr until a complete item is available.
+	class InputRing : public Input {
+	public:
+		InputRing(RingBuffer& ring);
+		
+		/// Returns the consumed bytes to the producer, also done on every refill.
+		auto release() -> void;
+	
+	protected:
+		auto fill(int count) -> bool override;
+		
+		auto read_direct(void* to, int count) -> void override;
+	
+	private:
+		auto set_window(uint64_t position, uint64_t available) -> void;
+		
+		RingBuffer* _ring;
+		uint8_t* _ring_data;
+		uint64_t _mask;
+		uint64_t _window_start;
+		uint8_t _scratch[16];
+	};
+}
@@ -0,0 +1,74 @@
+#include "InputStream.hpp"
+#include "../Exceptions/Exceptions.hpp"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <algorithm>
+
+namespace cbor {
+	InputStream::InputStream(size_t buffer_size) :
+		Input(nullptr, 0), _buffer(std::max(buffer_size, (size_t)64)), _end(false) {
+		_data = _buffer.data();
+	}
+	
+	auto InputStream::fill(int count) -> bool {
+		if(_offset > 0) {
+			memmove(_data, _data + _offset, _size - _offset);
+			_size -= _offset;
+			_offset = 0;
+		}
+		auto capacity = (int)_buffer.size();
+		while(!_end && _size < count && _size < capacity) {
+			auto read = read_source(_data + _size, capacity - _size);
+			if(read == 0) {
+				_end = true;
+			}
+			_size += (int)read;
+		}
+		// Longer payloads continue through read_direct, a truncated source is reported there.
+		return _size >= count || (_size == capacity && !_end);
+	}
+	
+	auto InputStream::read_direct(void* to, int count) -> void {
+		uint8_t discard[4096];
+		while(count > 0) {
+			auto target = to != nullptr ? (void*)to : (void*)discard;
+			auto size = to != nullptr ? (size_t)count : std::min((size_t)count, sizeof(discard));
+			auto read = _end ? 0 : read_source(target, size);
+			if(read == 0) {
+				_end = true;
+				throw_exception(DecodeException("unexpected end of input"));
+			}
+			if(to != nullptr) {
+				to = (uint8_t*)to + read;
+			}
+			count -= (int)read;
+		}
+	}
+	
+	InputFd::InputFd(int fd, size_t buffer_size) :
+		InputStream(buffer_size), _fd(fd) {
+	}
+	
+	auto InputFd::read_source(void* to, size_t size) -> size_t {
+		while(true) {
+			auto result = ::read(_fd, to, size);
+			if(result >= 0) {
+				return (size_t)result;
+			}
+			if(errno != EINTR) {
+				throw_exception(DecodeException(std::string("read failed: ") + strerror(errno)));
+			}
+		}
+	}
+	
+	InputIstream::InputIstream(std::istream& stream, size_t buffer_size) :
+		InputStream(buffer_size), _stream(&stream) {
+	}
+	
+	auto InputIstream::read_source(void* to, size_t size) -> size_t {
+		_stream->read((char*)to, (std::streamsize)size);
+		return (size_t)_stream->gcount();
+	}
+}
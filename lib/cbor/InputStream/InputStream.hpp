@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../Input/Input.hpp"
+#include <istream>
+#include <vector>
+#include <cstddef>
+
+namespace cbor {
+	/// Input refilled from a sequential source through a fixed-size buffer, memory stays bounded by the buffer size.
+	/// Payloads longer than the buffer are read straight into their destination.
+	class InputStream : public Input {
+	public:
+		static constexpr size_t default_buffer_size = 65536;
+		
+		InputStream(size_t buffer_size = default_buffer_size);
+		
+		InputStream(InputStream const&) = delete;
+		
+		auto operator=(InputStream const&) -> InputStream& = delete;
+	
+	protected:
+		/// Reads up to size bytes into to, returns 0 at the end of the source.
+		virtual auto read_source(void* to, size_t size) -> size_t = 0;
+		
+		auto fill(int count) -> bool override;
+		
+		auto read_direct(void* to, int count) -> void override;
+	
+	private:
+		std::vector<uint8_t> _buffer;
+		bool _end;
+	};
+	
+	class InputFd : public InputStream {
+	public:
+		InputFd(int fd, size_t buffer_size = default_buffer_size);
+	
+	protected:
+		auto read_source(void* to, size_t size) -> size_t override;
+	
+	private:
+		int _fd;
+	};
+	
+	class InputIstream : public InputStream {
+	public:
+		InputIstream(std::istream& stream, size_t buffer_size = default_buffer_size);
+	
+	protected:
+		auto read_source(void* to, size_t size) -> size_t override;
+	
+	private:
+		std::istream* _stream;
+	};
+}
@@ -0,0 +1,752 @@
+#include "Json.hpp"
+#include "../Encoder/Encoder.hpp"
+#include "../Reader/Reader.hpp"
+
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <charconv>
+#include <array>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CBOR_JSON_SSE2
+#endif
+
+namespace cbor {
+	static constexpr auto make_escape_table() -> std::array<uint8_t, 256> {
+		std::array<uint8_t, 256> table{};
+		for(size_t i = 0; i < 0x20; ++i) {
+			table[i] = 1;
+		}
+		table['"'] = 1;
+		table['\\'] = 1;
+		return table;
+	}
+	
+	static constexpr auto escape_table = make_escape_table();
+	
+	/// Offset of the first byte of data that needs escaping in a JSON string, or size.
+	static auto find_escape(const uint8_t* data, size_t size) -> size_t {
+		size_t i = 0;
+#ifdef CBOR_JSON_SSE2
+		auto quote = _mm_set1_epi8('"');
+		auto backslash = _mm_set1_epi8('\\');
+		auto control = _mm_set1_epi8(0x1f);
+		for(; i + 16 <= size; i += 16) {
+			auto block = _mm_loadu_si128((const __m128i*)(data + i));
+			auto special = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)),
+				_mm_cmpeq_epi8(_mm_max_epu8(block, control), control)
+			);
+			auto mask = _mm_movemask_epi8(special);
+			if(mask != 0) {
+				return i + __builtin_ctz(mask);
+			}
+		}
+#endif
+		while(i < size && escape_table[data[i]] == 0) {
+			++i;
+		}
+		return i;
+	}
+	
+	/// Bit i of each mask is set for byte i of a 64-byte block.
+	struct BlockMasks {
+		uint64_t quote;
+		uint64_t backslash;
+		uint64_t structural;
+	};
+	
+	static auto block_masks(const uint8_t* block) -> BlockMasks {
+		BlockMasks masks{0, 0, 0};
+#ifdef CBOR_JSON_SSE2
+		// '[' and ']' differ from '{' and '}' only in bit 0x20, so the four brackets take two compares
+		auto case_bit = _mm_set1_epi8(0x20);
+		auto open = _mm_set1_epi8('{');
+		auto close = _mm_set1_epi8('}');
+		auto comma = _mm_set1_epi8(',');
+		auto quote = _mm_set1_epi8('"');
+		auto backslash = _mm_set1_epi8('\\');
+		for(size_t i = 0; i < 64; i += 16) {
+			auto part = _mm_loadu_si128((const __m128i*)(block + i));
+			auto folded = _mm_or_si128(part, case_bit);
+			auto structural = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)),
+				_mm_cmpeq_epi8(part, comma)
+			);
+			masks.quote |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(part, quote)) << i;
+			masks.backslash |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(part, backslash)) << i;
+			masks.structural |= (uint64_t)(uint32_t)_mm_movemask_epi8(structural) << i;
+		}
+#else
+		for(size_t i = 0; i < 64; ++i) {
+			auto c = block[i];
+			masks.quote |= (uint64_t)(c == '"') << i;
+			masks.backslash |= (uint64_t)(c == '\\') << i;
+			masks.structural |= (uint64_t)(c == '{' || c == '}' || c == '[' || c == ']' || c == ',') << i;
+		}
+#endif
+		return masks;
+	}
+	
+	/// Bits of the characters escaped by a backslash, carry holds an escape that crosses into the next block.
+	static auto find_escaped(uint64_t backslash, uint64_t& carry) -> uint64_t {
+		constexpr uint64_t even_bits = 0x5555555555555555ull;
+		backslash &= ~carry;
+		auto follows_escape = backslash << 1 | carry;
+		// a run of backslashes escapes every second character, runs starting on odd bits are flipped by the addition
+		auto odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+		uint64_t sequences_starting_on_even_bits;
+		carry = __builtin_add_overflow(odd_sequence_starts, backslash, &sequences_starting_on_even_bits);
+		auto invert_mask = sequences_starting_on_even_bits << 1;
+		return (even_bits ^ invert_mask) & follows_escape;
+	}
+	
+	/// Bit i is the parity of the set bits up to i, turning quote bits into the inside of strings.
+	static auto prefix_xor(uint64_t bits) -> uint64_t {
+		bits ^= bits << 1;
+		bits ^= bits << 2;
+		bits ^= bits << 4;
+		bits ^= bits << 8;
+		bits ^= bits << 16;
+		bits ^= bits << 32;
+		return bits;
+	}
+	
+	/// Value of a number outside the range of double, infinity when it is large and zero when it is small.
+	static auto out_of_range(const uint8_t* data, const uint8_t* end, bool negative) -> double {
+		// the number is 0.d... times ten to the power of position plus the exponent
+		int64_t position = 0;
+		auto leading = true;
+		auto fraction = false;
+		for(; data < end && (*data | 0x20) != 'e'; ++data) {
+			if(*data == '.') {
+				fraction = true;
+			} else if(leading && *data == '0') {
+				position -= fraction ? 1 : 0;
+			} else {
+				leading = false;
+				position += fraction ? 0 : 1;
+			}
+		}
+		int64_t exponent = 0;
+		if(data < end) {
+			auto negative_exponent = *++data == '-';
+			if(*data == '+' || *data == '-') {
+				++data;
+			}
+			for(; data < end && exponent < INT_MAX; ++data) {
+				exponent = exponent * 10 + (*data - '0');
+			}
+			exponent = negative_exponent ? -exponent : exponent;
+		}
+		auto magnitude = position + exponent > 0 ? HUGE_VAL : 0.0;
+		return negative ? -magnitude : magnitude;
+	}
+	
+	static auto skip_whitespace(const uint8_t* data, size_t size, size_t offset) -> size_t {
+		while(offset < size && (data[offset] == ' ' || data[offset] == '\n' || data[offset] == '\r' || data[offset] == '\t')) {
+			++offset;
+		}
+		return offset;
+	}
+	
+	JsonTranscoder::JsonTranscoder() :
+		_output(nullptr), _buffer_size(0) {
+	}
+	
+	auto JsonTranscoder::flush() -> void {
+		if(_buffer_size > 0) {
+			_output->put_bytes((const unsigned char*)_buffer, _buffer_size);
+			_buffer_size = 0;
+		}
+	}
+	
+	auto JsonTranscoder::put(char value) -> void {
+		if(_buffer_size == sizeof(_buffer)) {
+			flush();
+		}
+		_buffer[_buffer_size++] = value;
+	}
+	
+	auto JsonTranscoder::put(const void* data, size_t size) -> void {
+		if(size > sizeof(_buffer) - _buffer_size) {
+			flush();
+			if(size >= sizeof(_buffer)) {
+				_output->put_bytes((const unsigned char*)data, size);
+				return;
+			}
+		}
+		memcpy(_buffer + _buffer_size, data, size);
+		_buffer_size += size;
+	}
+	
+	auto JsonTranscoder::put_head(int major_type, uint64_t value) -> void {
+		if(sizeof(_buffer) - _buffer_size < 9) {
+			flush();
+		}
+		auto head = (unsigned char*)_buffer + _buffer_size;
+		major_type <<= 5;
+		if(value < 24) {
+			head[0] = (unsigned char)(major_type | value);
+			_buffer_size += 1;
+			return;
+		}
+		size_t width = value < 256 ? 1 : value < 65536 ? 2 : value < 4294967296ULL ? 4 : 8;
+		head[0] = (unsigned char)(major_type | (width == 1 ? 24 : width == 2 ? 25 : width == 4 ? 26 : 27));
+		for(size_t i = 0; i < width; ++i) {
+			head[1 + i] = (unsigned char)(value >> ((width - 1 - i) * 8));
+		}
+		_buffer_size += 1 + width;
+	}
+	
+	auto JsonTranscoder::put_json_string(const uint8_t* data, size_t size) -> void {
+		static constexpr char hex[] = "0123456789abcdef";
+		put('"');
+		while(size > 0) {
+			auto run = find_escape(data, size);
+			put(data, run);
+			if(run == size) {
+				break;
+			}
+			auto c = data[run];
+			char escaped[6] = {'\\', 0, 0, 0, 0, 0};
+			size_t length = 2;
+			switch(c) {
+				case '"':
+				case '\\':
+					escaped[1] = (char)c;
+					break;
+				case '\n':
+					escaped[1] = 'n';
+					break;
+				case '\r':
+					escaped[1] = 'r';
+					break;
+				case '\t':
+					escaped[1] = 't';
+					break;
+				case '\b':
+					escaped[1] = 'b';
+					break;
+				case '\f':
+					escaped[1] = 'f';
+					break;
+				default:
+					escaped[1] = 'u';
+					escaped[2] = '0';
+					escaped[3] = '0';
+					escaped[4] = hex[c >> 4];
+					escaped[5] = hex[c & 0xf];
+					length = 6;
+					break;
+			}
+			put(escaped, length);
+			data += run + 1;
+			size -= run + 1;
+		}
+		put('"');
+	}
+	
+	auto JsonTranscoder::put_base64(const uint8_t* data, size_t size) -> void {
+		static constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+		put('"');
+		char group[4];
+		for(; size >= 3; data += 3, size -= 3) {
+			uint32_t bits = ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
+			group[0] = alphabet[bits >> 18];
+			group[1] = alphabet[(bits >> 12) & 0x3f];
+			group[2] = alphabet[(bits >> 6) & 0x3f];
+			group[3] = alphabet[bits & 0x3f];
+			put(group, 4);
+		}
+		if(size > 0) {
+			uint32_t bits = ((uint32_t)data[0] << 16) | (size > 1 ? (uint32_t)data[1] << 8 : 0);
+			group[0] = alphabet[bits >> 18];
+			group[1] = alphabet[(bits >> 12) & 0x3f];
+			group[2] = alphabet[(bits >> 6) & 0x3f];
+			put(group, size + 1);
+		}
+		put('"');
+	}
+	
+	auto JsonTranscoder::put_double(double value) -> void {
+		if(!isfinite(value)) {
+			put("null", 4);
+			return;
+		}
+		char text[32];
+		auto result = std::to_chars(text, text + sizeof(text), value);
+		put(text, result.ptr - text);
+	}
+	
+	auto JsonTranscoder::to_json(const void* data, size_t size, Output& output) -> Error {
+		auto bytes = (const uint8_t*)data;
+		if(size == 0) {
+			return {ErrorCode::Empty, 0};
+		}
+		_output = &output;
+		_buffer_size = 0;
+		_frames.clear();
+		size_t offset = 0;
+		auto fail = [&](ErrorCode code, size_t at) -> Error {
+			flush();
+			return {code, at};
+		};
+		while(true) {
+			if(offset >= size) {
+				return fail(ErrorCode::UnexpectedEnd, offset);
+			}
+			auto start = offset;
+			uint8_t major_type = bytes[offset] >> 5;
+			uint8_t minor_type = bytes[offset] & 0b00011111;
+			++offset;
+			uint64_t value = minor_type;
+			if(minor_type >= 28) {
+				return fail(ErrorCode::InvalidHead, start);
+			}
+			if(minor_type >= 24) {
+				size_t width = (size_t)1 << (minor_type - 24);
+				if(size - offset < width) {
+					return fail(ErrorCode::UnexpectedEnd, size);
+				}
+				value = 0;
+				for(size_t i = 0; i < width; ++i) {
+					value = (value << 8) | bytes[offset++];
+				}
+			}
+			if(major_type == 6) {
+				// JSON has no tags, the tagged item is written on its own in the same slot
+				continue;
+			}
+			if(!_frames.empty()) {
+				auto const& frame = _frames.back();
+				if(frame.is_map && frame.index % 2 == 0 && major_type != 3) {
+					return fail(ErrorCode::InvalidMapKey, start);
+				}
+				if(frame.index > 0) {
+					put(frame.is_map && frame.index % 2 == 1 ? ':' : ',');
+				}
+			}
+			
+			char text[24];
+			switch(major_type) {
+				case 0: {
+					auto result = std::to_chars(text, text + sizeof(text), value);
+					put(text, result.ptr - text);
+					break;
+				}
+				case 1: {
+					put('-');
+					if(value == UINT64_MAX) {
+						put("18446744073709551616", 20);
+					} else {
+						auto result = std::to_chars(text, text + sizeof(text), value + 1);
+						put(text, result.ptr - text);
+					}
+					break;
+				}
+				case 2:
+				case 3:
+					if(minor_type == 27 || value > INT_MAX) {
+						return fail(ErrorCode::TooLong, start);
+					}
+					if(size - offset < value) {
+						return fail(ErrorCode::UnexpectedEnd, size);
+					}
+					if(major_type == 2) {
+						put_base64(bytes + offset, value);
+					} else {
+						put_json_string(bytes + offset, value);
+					}
+					offset += value;
+					break;
+				case 4:
+				case 5:
+					if(minor_type == 27) {
+						return fail(ErrorCode::TooLong, start);
+					}
+					put(major_type == 4 ? '[' : '{');
+					if(value > 0) {
+						_frames.push_back({major_type == 5 ? value * 2 : value, 0, major_type == 5});
+						continue;
+					}
+					put(major_type == 4 ? ']' : '}');
+					break;
+				default:
+					if(minor_type == 20) {
+						put("false", 5);
+					} else if(minor_type == 21) {
+						put("true", 4);
+					} else if(minor_type == 25) {
+						put_double(half_to_double((uint16_t)value));
+					} else if(minor_type == 26) {
+						auto bits = (uint32_t)value;
+						float single;
+						memcpy(&single, &bits, sizeof(single));
+						put_double(single);
+					} else if(minor_type == 27) {
+						double number;
+						memcpy(&number, &value, sizeof(number));
+						put_double(number);
+					} else {
+						put("null", 4);
+					}
+					break;
+			}
+			
+			// closes every container the finished item completes
+			while(!_frames.empty()) {
+				auto& frame = _frames.back();
+				++frame.index;
+				if(--frame.remaining > 0) {
+					break;
+				}
+				put(frame.is_map ? '}' : ']');
+				_frames.pop_back();
+			}
+			if(_frames.empty()) {
+				if(offset < size) {
+					return fail(ErrorCode::TrailingData, offset);
+				}
+				flush();
+				return {};
+			}
+		}
+	}
+	
+	auto JsonTranscoder::scan(const uint8_t* data, size_t size) -> Error {
+		_counts.clear();
+		_open.clear();
+		uint64_t escape_carry = 0;
+		uint64_t in_string_carry = 0;
+		uint8_t tail[64];
+		for(size_t base = 0; base < size; base += 64) {
+			auto block = data + base;
+			if(size - base < 64) {
+				memset(tail, ' ', sizeof(tail));
+				memcpy(tail, block, size - base);
+				block = tail;
+			}
+			auto masks = block_masks(block);
+			auto quote = masks.quote & ~find_escaped(masks.backslash, escape_carry);
+			auto in_string = prefix_xor(quote) ^ in_string_carry;
+			in_string_carry = (uint64_t)((int64_t)in_string >> 63);
+			auto structural = masks.structural & ~in_string;
+			while(structural != 0) {
+				auto offset = base + __builtin_ctzll(structural);
+				structural &= structural - 1;
+				auto c = data[offset];
+				if(c == '[' || c == '{') {
+					_open.push_back({_counts.size(), offset});
+					_counts.push_back(0);
+				} else if(c == ',') {
+					if(_open.empty()) {
+						return {ErrorCode::InvalidJson, offset};
+					}
+					++_counts[_open.back().count];
+				} else {
+					// the closing bracket is the opening one plus two
+					if(_open.empty() || data[_open.back().offset] + 2 != c) {
+						return {ErrorCode::InvalidJson, offset};
+					}
+					auto last = offset;
+					while(data[last - 1] == ' ' || data[last - 1] == '\n' || data[last - 1] == '\r' || data[last - 1] == '\t') {
+						--last;
+					}
+					if(last - 1 != _open.back().offset) {
+						++_counts[_open.back().count];
+					}
+					_open.pop_back();
+				}
+			}
+		}
+		if(in_string_carry != 0) {
+			return {ErrorCode::InvalidJson, size};
+		}
+		if(!_open.empty()) {
+			return {ErrorCode::InvalidJson, _open.back().offset};
+		}
+		return {};
+	}
+	
+	static auto parse_hex4(const uint8_t* data, uint32_t& result) -> bool {
+		result = 0;
+		for(size_t i = 0; i < 4; ++i) {
+			auto c = data[i];
+			uint32_t digit;
+			if(c >= '0' && c <= '9') {
+				digit = c - '0';
+			} else if((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+				digit = (c | 0x20) - 'a' + 10;
+			} else {
+				return false;
+			}
+			result = (result << 4) | digit;
+		}
+		return true;
+	}
+	
+	static auto append_utf8(std::string& to, uint32_t code_point) -> void {
+		if(code_point < 0x80) {
+			to.push_back((char)code_point);
+		} else if(code_point < 0x800) {
+			to.push_back((char)(0xc0 | (code_point >> 6)));
+			to.push_back((char)(0x80 | (code_point & 0x3f)));
+		} else if(code_point < 0x10000) {
+			to.push_back((char)(0xe0 | (code_point >> 12)));
+			to.push_back((char)(0x80 | ((code_point >> 6) & 0x3f)));
+			to.push_back((char)(0x80 | (code_point & 0x3f)));
+		} else {
+			to.push_back((char)(0xf0 | (code_point >> 18)));
+			to.push_back((char)(0x80 | ((code_point >> 12) & 0x3f)));
+			to.push_back((char)(0x80 | ((code_point >> 6) & 0x3f)));
+			to.push_back((char)(0x80 | (code_point & 0x3f)));
+		}
+	}
+	
+	auto JsonTranscoder::parse_string(const uint8_t* data, size_t size, size_t& offset, const uint8_t*& result, size_t& result_size) -> bool {
+		auto start = ++offset;
+		offset += find_escape(data + offset, size - offset);
+		if(offset < size && data[offset] == '"') {
+			// no escapes, the string is written straight from the input
+			result = data + start;
+			result_size = offset - start;
+			++offset;
+			return true;
+		}
+		_string.assign((const char*)data + start, offset - start);
+		while(true) {
+			if(offset >= size || data[offset] < 0x20) {
+				return false;
+			}
+			if(data[offset] == '"') {
+				++offset;
+				break;
+			}
+			if(size - offset < 2) {
+				return false;
+			}
+			auto c = data[offset + 1];
+			offset += 2;
+			switch(c) {
+				case '"':
+				case '\\':
+				case '/':
+					_string.push_back((char)c);
+					break;
+				case 'b':
+					_string.push_back('\b');
+					break;
+				case 'f':
+					_string.push_back('\f');
+					break;
+				case 'n':
+					_string.push_back('\n');
+					break;
+				case 'r':
+					_string.push_back('\r');
+					break;
+				case 't':
+					_string.push_back('\t');
+					break;
+				case 'u': {
+					uint32_t code_point;
+					if(size - offset < 4 || !parse_hex4(data + offset, code_point)) {
+						return false;
+					}
+					offset += 4;
+					if(code_point >= 0xd800 && code_point < 0xdc00) {
+						uint32_t low;
+						if(size - offset < 6 || data[offset] != '\\' || data[offset + 1] != 'u' ||
+							!parse_hex4(data + offset + 2, low) || low < 0xdc00 || low >= 0xe000) {
+							return false;
+						}
+						offset += 6;
+						code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+					} else if(code_point >= 0xdc00 && code_point < 0xe000) {
+						return false;
+					}
+					append_utf8(_string, code_point);
+					break;
+				}
+				default:
+					return false;
+			}
+			auto run = find_escape(data + offset, size - offset);
+			_string.append((const char*)data + offset, run);
+			offset += run;
+		}
+		result = (const uint8_t*)_string.data();
+		result_size = _string.size();
+		return true;
+	}
+	
+	auto JsonTranscoder::to_cbor(const void* data, size_t size, Output& output) -> Error {
+		auto bytes = (const uint8_t*)data;
+		auto offset = skip_whitespace(bytes, size, 0);
+		if(offset == size) {
+			return {ErrorCode::Empty, offset};
+		}
+		if(size > UINT32_MAX) {
+			return {ErrorCode::TooLong, 0};
+		}
+		if(auto error = scan(bytes, size)) {
+			return error;
+		}
+		_output = &output;
+		_buffer_size = 0;
+		_frames.clear();
+		auto fail = [&](ErrorCode code, size_t at) -> Error {
+			flush();
+			return {code, at};
+		};
+		size_t next_count = 0;
+		const uint8_t* string;
+		size_t string_size;
+		auto expect = [&](char c) {
+			offset = skip_whitespace(bytes, size, offset);
+			if(offset < size && bytes[offset] == c) {
+				++offset;
+				return true;
+			}
+			return false;
+		};
+		auto parse_key = [&]() {
+			offset = skip_whitespace(bytes, size, offset);
+			if(offset >= size || bytes[offset] != '"' || !parse_string(bytes, size, offset, string, string_size)) {
+				return false;
+			}
+			put_head(3, string_size);
+			put(string, string_size);
+			return expect(':');
+		};
+		while(true) {
+			offset = skip_whitespace(bytes, size, offset);
+			if(offset >= size) {
+				return fail(ErrorCode::InvalidJson, offset);
+			}
+			auto start = offset;
+			auto c = bytes[offset];
+			if(c == '[' || c == '{') {
+				auto count = _counts[next_count++];
+				++offset;
+				put_head(c == '[' ? 4 : 5, count);
+				if(count > 0) {
+					_frames.push_back({count, 0, c == '{'});
+					if(c == '{' && !parse_key()) {
+						return fail(ErrorCode::InvalidJson, offset);
+					}
+					continue;
+				}
+				if(!expect(c == '[' ? ']' : '}')) {
+					return fail(ErrorCode::InvalidJson, offset);
+				}
+			} else if(c == '"') {
+				if(!parse_string(bytes, size, offset, string, string_size)) {
+					return fail(ErrorCode::InvalidJson, start);
+				}
+				put_head(3, string_size);
+				put(string, string_size);
+			} else if(c == 't' || c == 'f' || c == 'n') {
+				auto literal = c == 't' ? "true" : c == 'f' ? "false" : "null";
+				auto length = strlen(literal);
+				if(size - offset < length || memcmp(bytes + offset, literal, length) != 0) {
+					return fail(ErrorCode::InvalidJson, start);
+				}
+				offset += length;
+				put((char)(c == 'n' ? 0xf6 : c == 't' ? 0xf5 : 0xf4));
+			} else if(c == '-' || (c >= '0' && c <= '9')) {
+				auto negative = c == '-';
+				offset += negative ? 1 : 0;
+				auto digits = offset;
+				uint64_t magnitude = 0;
+				auto overflow = false;
+				while(offset < size && bytes[offset] >= '0' && bytes[offset] <= '9') {
+					uint64_t digit = bytes[offset] - '0';
+					overflow = overflow || magnitude > (UINT64_MAX - digit) / 10;
+					magnitude = magnitude * 10 + digit;
+					++offset;
+				}
+				if(offset == digits || (bytes[digits] == '0' && offset - digits > 1)) {
+					return fail(ErrorCode::InvalidJson, start);
+				}
+				auto is_integer = true;
+				if(offset < size && bytes[offset] == '.') {
+					is_integer = false;
+					auto fraction = ++offset;
+					while(offset < size && bytes[offset] >= '0' && bytes[offset] <= '9') {
+						++offset;
+					}
+					if(offset == fraction) {
+						return fail(ErrorCode::InvalidJson, start);
+					}
+				}
+				if(offset < size && (bytes[offset] | 0x20) == 'e') {
+					is_integer = false;
+					++offset;
+					if(offset < size && (bytes[offset] == '+' || bytes[offset] == '-')) {
+						++offset;
+					}
+					auto exponent = offset;
+					while(offset < size && bytes[offset] >= '0' && bytes[offset] <= '9') {
+						++offset;
+					}
+					if(offset == exponent) {
+						return fail(ErrorCode::InvalidJson, start);
+					}
+				}
+				if(is_integer && !overflow && (!negative || magnitude > 0)) {
+					put_head(negative ? 1 : 0, negative ? magnitude - 1 : magnitude);
+				} else if(is_integer && !overflow) {
+					put_head(0, 0);
+				} else {
+					double number;
+					auto result = std::from_chars((const char*)bytes + start, (const char*)bytes + offset, number);
+					if(result.ec == std::errc::result_out_of_range) {
+						number = out_of_range(bytes + digits, bytes + offset, negative);
+					}
+					flush();
+					Encoder(output).write_double(number);
+				}
+			} else {
+				return fail(ErrorCode::InvalidJson, start);
+			}
+			
+			// closes every container the finished value completes and reads the separator of the next one
+			while(true) {
+				if(_frames.empty()) {
+					offset = skip_whitespace(bytes, size, offset);
+					if(offset < size) {
+						return fail(ErrorCode::TrailingData, offset);
+					}
+					flush();
+					return {};
+				}
+				auto& frame = _frames.back();
+				if(--frame.remaining == 0) {
+					if(!expect(frame.is_map ? '}' : ']')) {
+						return fail(ErrorCode::InvalidJson, offset);
+					}
+					_frames.pop_back();
+					continue;
+				}
+				if(!expect(',') || (frame.is_map && !parse_key())) {
+					return fail(ErrorCode::InvalidJson, offset);
+				}
+				break;
+			}
+		}
+	}
+	
+	auto cbor_to_json(const void* data, size_t size, Output& output) -> Error {
+		thread_local JsonTranscoder transcoder;
+		return transcoder.to_json(data, size, output);
+	}
+	
+	auto json_to_cbor(const void* data, size_t size, Output& output) -> Error {
+		thread_local JsonTranscoder transcoder;
+		return transcoder.to_cbor(data, size, output);
+	}
+}
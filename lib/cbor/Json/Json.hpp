@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../Output/Output.hpp"
+#include "../Error/Error.hpp"
+#include <vector>
+#include <string>
+
+namespace cbor {
+	/// Converts between CBOR and JSON text without building Object trees and keeps its scratch buffers between calls.
+	/// Tags are dropped and only the tagged item is written, byte strings become unpadded base64url,
+	/// NaN, infinities and simple values other than true, false and null become null.
+	class JsonTranscoder {
+	public:
+		JsonTranscoder();
+		
+		JsonTranscoder(JsonTranscoder const&) = delete;
+		
+		auto operator=(JsonTranscoder const&) -> JsonTranscoder& = delete;
+		
+		/// Writes one CBOR document as JSON, on error output holds the text written so far.
+		auto to_json(const void* data, size_t size, Output& output) -> Error;
+		
+		/// Writes one JSON document as CBOR, numbers without a fraction or exponent that fit 64 bits stay integers.
+		/// A structural pre-scan counts the items of every container, so the memory used grows only with their number.
+		auto to_cbor(const void* data, size_t size, Output& output) -> Error;
+	
+	private:
+		struct Frame {
+			uint64_t remaining;
+			uint64_t index;
+			bool is_map;
+		};
+		
+		struct OpenBracket {
+			size_t count;
+			size_t offset;
+		};
+		
+		auto put(char value) -> void;
+		
+		auto put(const void* data, size_t size) -> void;
+		
+		auto flush() -> void;
+		
+		auto put_head(int major_type, uint64_t value) -> void;
+		
+		auto put_json_string(const uint8_t* data, size_t size) -> void;
+		
+		auto put_base64(const uint8_t* data, size_t size) -> void;
+		
+		auto put_double(double value) -> void;
+		
+		auto scan(const uint8_t* data, size_t size) -> Error;
+		
+		/// Parses the string starting at the quote at offset, result points either into data or into _string.
+		auto parse_string(const uint8_t* data, size_t size, size_t& offset, const uint8_t*& result, size_t& result_size) -> bool;
+		
+		std::vector<Frame> _frames;
+		std::vector<OpenBracket> _open;
+		std::vector<uint64_t> _counts;
+		std::string _string;
+		Output* _output;
+		size_t _buffer_size;
+		char _buffer[4096];
+	};
+	
+	/// Transcodes with a transcoder of the calling thread.
+	auto cbor_to_json(const void* data, size_t size, Output& output) -> Error;
+	
+	auto json_to_cbor(const void* data, size_t size, Output& output) -> Error;
+}
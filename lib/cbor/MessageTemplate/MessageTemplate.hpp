@@ -0,0 +1,256 @@
+#pragma once
+
+#include "../Exceptions/Exceptions.hpp"
+#include <array>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+
+namespace cbor {
+	/// Slot of a message template with a fixed-width head, overwritten in place at runtime.
+	struct Hole {
+		size_t offset = 0;
+		uint8_t major_type = 0;
+		uint8_t width = 0;
+		size_t length = 0;
+		
+		/// Writes an unsigned integer into a uint hole of a message copied from the template.
+		auto patch_uint(uint8_t* message, uint64_t value) const -> void {
+			if(major_type != 0) {
+				throw_exception(EncodeException("hole is not an integer"));
+			}
+			put_value(message, value);
+		}
+		
+		/// Writes a signed integer into an int hole, the head byte switches between major types 0 and 1.
+		auto patch_int(uint8_t* message, int64_t value) const -> void {
+			if(major_type != 1) {
+				throw_exception(EncodeException("hole is not a signed integer"));
+			}
+			if(value < 0) {
+				message[offset] = (uint8_t)((1 << 5) | head_minor());
+				put_value(message, (uint64_t)-(value + 1));
+			} else {
+				message[offset] = (uint8_t)head_minor();
+				put_value(message, (uint64_t)value);
+			}
+		}
+		
+		/// Writes the payload of a bytes or string hole, data must have exactly the declared length.
+		auto patch_bytes(uint8_t* message, const void* data, size_t size) const -> void {
+			if(major_type != 2 && major_type != 3) {
+				throw_exception(EncodeException("hole is not a bytes or string"));
+			}
+			if(size != length) {
+				throw_exception(EncodeException("hole length mismatch"));
+			}
+			memcpy(message + payload_offset(), data, size);
+		}
+		
+		/// Offset of the bytes that change on every patch, for building iovecs around holes.
+		constexpr auto payload_offset() const -> size_t {
+			return offset + 1 + (major_type < 2 ? 0 : width);
+		}
+	
+	private:
+		constexpr auto head_minor() const -> int {
+			return width == 1 ? 24 : width == 2 ? 25 : width == 4 ? 26 : 27;
+		}
+		
+		auto put_value(uint8_t* message, uint64_t value) const -> void {
+			if(width < 8 && value >> (width * 8) != 0) {
+				throw_exception(EncodeException("value does not fit into hole"));
+			}
+			for(size_t i = 0; i < width; ++i) {
+				message[offset + 1 + i] = (uint8_t)(value >> ((width - 1 - i) * 8));
+			}
+		}
+	};
+	
+	/// Encoded bytes of a fixed-shape message together with the holes left in it.
+	template<size_t Size_, size_t Holes_>
+	struct MessageTemplate {
+		std::array<uint8_t, Size_> bytes;
+		std::array<Hole, Holes_> holes;
+		
+		constexpr auto size() const -> size_t {
+			return Size_;
+		}
+		
+		constexpr auto instantiate() const -> std::array<uint8_t, Size_> {
+			return bytes;
+		}
+	};
+	
+	/// Constexpr encoder writing into a fixed array, with Size_ == 0 it only measures the template.
+	template<size_t Size_, size_t Holes_>
+	class TemplateEncoder {
+	public:
+		constexpr auto write_bool(bool value) -> void {
+			put_byte(value ? 0xf5 : 0xf4);
+		}
+		
+		constexpr auto write_int(int64_t value) -> void {
+			if(value < 0) {
+				write_type_value(1, (uint64_t)-(value + 1));
+			} else {
+				write_type_value(0, (uint64_t)value);
+			}
+		}
+		
+		constexpr auto write_uint(uint64_t value) -> void {
+			write_type_value(0, value);
+		}
+		
+		constexpr auto write_bytes(const uint8_t* data, size_t size) -> void {
+			write_type_value(2, size);
+			for(size_t i = 0; i < size; ++i) {
+				put_byte(data[i]);
+			}
+		}
+		
+		constexpr auto write_string(std::string_view str) -> void {
+			write_type_value(3, str.size());
+			for(auto c: str) {
+				put_byte((uint8_t)c);
+			}
+		}
+		
+		constexpr auto write_array(size_t size) -> void {
+			write_type_value(4, size);
+		}
+		
+		constexpr auto write_map(size_t size) -> void {
+			write_type_value(5, size);
+		}
+		
+		constexpr auto write_tag(uint64_t tag) -> void {
+			write_type_value(6, tag);
+		}
+		
+		constexpr auto write_null() -> void {
+			put_byte(0xf6);
+		}
+		
+		constexpr auto write_undefined() -> void {
+			put_byte(0xf7);
+		}
+		
+		/// Reserves an unsigned integer encoded with a width-byte argument, returns the hole index.
+		constexpr auto write_uint_hole(uint8_t width = 8) -> size_t {
+			return write_hole(0, width, 0);
+		}
+		
+		/// Reserves a signed integer encoded with a width-byte argument, returns the hole index.
+		constexpr auto write_int_hole(uint8_t width = 8) -> size_t {
+			return write_hole(1, width, 0);
+		}
+		
+		/// Reserves a byte string of exactly length bytes, returns the hole index.
+		constexpr auto write_bytes_hole(size_t length) -> size_t {
+			return write_hole(2, 0, length);
+		}
+		
+		/// Reserves a text string of exactly length bytes, returns the hole index.
+		constexpr auto write_string_hole(size_t length) -> size_t {
+			return write_hole(3, 0, length);
+		}
+		
+		constexpr auto size() const -> size_t {
+			return _size;
+		}
+		
+		constexpr auto hole_count() const -> size_t {
+			return _hole_count;
+		}
+		
+		constexpr auto result() const -> MessageTemplate<Size_, Holes_> {
+			if(_size != Size_ || _hole_count != Holes_) {
+				throw_exception(EncodeException("message template size mismatch"));
+			}
+			return {_bytes, _holes};
+		}
+	
+	private:
+		constexpr auto put_byte(uint8_t value) -> void {
+			if constexpr(Size_ > 0) {
+				if(_size >= Size_) {
+					throw_exception(EncodeException("message template overflow"));
+				}
+				_bytes[_size] = value;
+			}
+			++_size;
+		}
+		
+		constexpr auto put_value(uint64_t value, uint8_t width) -> void {
+			for(size_t i = 0; i < width; ++i) {
+				put_byte((uint8_t)(value >> ((width - 1 - i) * 8)));
+			}
+		}
+		
+		constexpr auto write_type_value(int major_type, uint64_t value) -> void {
+			major_type <<= 5;
+			if(value < 24ULL) {
+				put_byte((uint8_t)(major_type | value));
+			} else if(value < 256ULL) {
+				put_byte((uint8_t)(major_type | 24));
+				put_value(value, 1);
+			} else if(value < 65536ULL) {
+				put_byte((uint8_t)(major_type | 25));
+				put_value(value, 2);
+			} else if(value < 4294967296ULL) {
+				put_byte((uint8_t)(major_type | 26));
+				put_value(value, 4);
+			} else {
+				put_byte((uint8_t)(major_type | 27));
+				put_value(value, 8);
+			}
+		}
+		
+		constexpr auto write_hole(uint8_t major_type, uint8_t width, size_t length) -> size_t {
+			Hole hole{_size, major_type, width, length};
+			if(major_type < 2) {
+				if(width != 1 && width != 2 && width != 4 && width != 8) {
+					throw_exception(EncodeException("invalid hole width"));
+				}
+				put_byte((uint8_t)(width == 1 ? 24 : width == 2 ? 25 : width == 4 ? 26 : 27));
+				put_value(0, width);
+			} else {
+				auto head_size = _size;
+				write_type_value(major_type, length);
+				hole.width = (uint8_t)(_size - head_size - 1);
+				for(size_t i = 0; i < length; ++i) {
+					put_byte(0);
+				}
+			}
+			if constexpr(Holes_ > 0) {
+				if(_hole_count >= Holes_) {
+					throw_exception(EncodeException("message template overflow"));
+				}
+				_holes[_hole_count] = hole;
+			}
+			return _hole_count++;
+		}
+		
+		std::array<uint8_t, Size_> _bytes{};
+		std::array<Hole, Holes_> _holes{};
+		size_t _size = 0;
+		size_t _hole_count = 0;
+	};
+	
+	template<typename Description_>
+	constexpr auto measure_template() -> TemplateEncoder<0, 0> {
+		TemplateEncoder<0, 0> encoder{};
+		Description_::build(encoder);
+		return encoder;
+	}
+	
+	/// Encodes Description_::build(encoder) at compile time into a MessageTemplate of exact size.
+	template<typename Description_>
+	constexpr auto make_template() {
+		constexpr auto measure = measure_template<Description_>();
+		TemplateEncoder<measure.size(), measure.hole_count()> encoder{};
+		Description_::build(encoder);
+		return encoder.result();
+	}
+}
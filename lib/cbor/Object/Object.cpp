@@ -26,7 +26,7 @@ namespace cbor {
 	}
 	
 	PObject Object::from_tag(TagValue value) {
-		return from<ObjectType::Tag>(value);
+		return from<ObjectType::Tag>(std::move(value));
 	}
 	
 	PObject Object::create_undefined() {
@@ -54,10 +54,144 @@ namespace cbor {
 	}
 	
 	PObject Object::from_extra_tag(ExtraTagValue value) {
-		return from<ObjectType::ExtraTag>(value);
+		return from<ObjectType::ExtraTag>(std::move(value));
+	}
+	
+	PObject Object::from_tag(uint64_t tag, PObject item) {
+		if(tag > UINT32_MAX) {
+			return from<ObjectType::ExtraTag>({tag, std::move(item)});
+		}
+		return from<ObjectType::Tag>({(uint32_t)tag, std::move(item)});
 	}
 	
 	PObject Object::from_extra_special(ExtraSpecialValue value) {
 		return from<ObjectType::ExtraSpecial>(value);
 	}
+	
+	PObject Object::from_blob(BlobValue value) {
+		return from<ObjectType::Blob>(value);
+	}
+	
+	PObject Object::from_native(NativeValue value) {
+		return from<ObjectType::Native>(std::move(value));
+	}
+	
+	/// Containers being destroyed recursively on this thread, beyond max_release_depth they are released from a stack.
+	thread_local static size_t release_depth = 0;
+	
+	constexpr size_t max_release_depth = 256;
+	
+	/// Set while a subtree is released from a stack, nested destructors hand their containers to it.
+	thread_local static std::vector<PObject>* releasing = nullptr;
+	
+	/// Moves out the children that are unshared containers and frees the rest, in one pass over the children.
+	static auto release_children(Object& object, std::vector<PObject>& to) -> void {
+		auto release = [&](PObject& item) {
+			if(item && (item->is_array() || item->is_map() || item->is_tagged()) && item.use_count() == 1) {
+				to.push_back(std::move(item));
+			} else {
+				item.reset();
+			}
+		};
+		if(object.is_array()) {
+			for(auto& item: object.as<ObjectType::Array>()) {
+				release(item);
+			}
+		} else if(object.is_tagged()) {
+			release(object.tagged_item());
+		} else {
+			for(auto& p: object.as<ObjectType::Map>()) {
+				release(p.second);
+			}
+		}
+	}
+	
+	Object::~Object() {
+		// a moved-from map is checked through the const accessor, it must not allocate here
+		if(!(is_array() && !as_array().empty()) && !(is_map() && !as_map().empty()) && !(is_tagged() && tagged_item())) {
+			return;
+		}
+		if(releasing != nullptr) {
+			release_children(*this, *releasing);
+			return;
+		}
+		if(release_depth < max_release_depth) {
+			// the usual shallow tree is freed recursively, the children are cleared here to count the depth
+			++release_depth;
+			if(is_array()) {
+				as<ObjectType::Array>().clear();
+			} else if(is_tagged()) {
+				tagged_item().reset();
+			} else {
+				as<ObjectType::Map>().clear();
+			}
+			--release_depth;
+			return;
+		}
+		std::vector<PObject> pending;
+		releasing = &pending;
+		release_children(*this, pending);
+		while(!pending.empty()) {
+			// the last reference goes away here, the destructor of the child pushes its own containers
+			auto child = std::move(pending.back());
+			pending.pop_back();
+		}
+		releasing = nullptr;
+	}
+	
+	/// Bytes of a string buffer that does not fit into the small string storage.
+	static auto string_heap(std::string const& value) -> size_t {
+		return value.capacity() >= sizeof(std::string) / 2 ? value.capacity() + 1 : 0;
+	}
+	
+	auto Object::memory_usage() const -> size_t {
+		// the nodes are summed in any order, so an explicit stack keeps deep trees off the call stack
+		thread_local std::vector<Object const*> stack;
+		stack.clear();
+		stack.push_back(this);
+		size_t result = 0;
+		while(!stack.empty()) {
+			auto const& node = *stack.back();
+			stack.pop_back();
+			// node and control block of make_shared
+			result += sizeof(Object) + 2 * sizeof(void*);
+			switch(node.object_type()) {
+				case ObjectType::String:
+					result += string_heap(node.as_string());
+					break;
+				case ObjectType::Error:
+					result += string_heap(node.as<ObjectType::Error>());
+					break;
+				case ObjectType::Bytes:
+					result += node.as_bytes().capacity();
+					break;
+				case ObjectType::Array:
+					result += node.as_array().capacity() * sizeof(PObject);
+					for(auto const& item: node.as_array()) {
+						if(item) {
+							stack.push_back(item.get());
+						}
+					}
+					break;
+				case ObjectType::Tag:
+				case ObjectType::ExtraTag:
+					if(node.tagged_item()) {
+						stack.push_back(node.tagged_item().get());
+					}
+					break;
+				case ObjectType::Map:
+					for(auto const& p: node.as_map()) {
+						// red-black tree node: color, three links and the value
+						result += 4 * sizeof(void*) + sizeof(MapValue::value_type) + string_heap(p.first);
+						if(p.second) {
+							stack.push_back(p.second.get());
+						}
+					}
+					break;
+				default:
+					break;
+			}
+		}
+		return result;
+	}
 }
\ No newline at end of file
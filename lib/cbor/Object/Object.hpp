@@ -23,6 +23,8 @@ namespace cbor {
 		ExtraInt,
 		ExtraTag,
 		ExtraSpecial,
+		Blob,
+		Native,
 	};
 	
 	struct Object;
@@ -34,15 +36,42 @@ namespace cbor {
 	using StringValue = std::string;
 	using ArrayValue = std::vector<PObject>;
 	using MapValue = std::map<std::string, PObject, std::less<std::string> >;
-	using TagValue = uint32_t;
 	using SpecialValue = uint32_t;
 	using UndefinedValue = std::monostate;
 	using NullValue = std::monostate;
 	using ErrorValue = std::string;
 	using ExtraIntValue = std::pair<bool, uint64_t>;
-	using ExtraTagValue = uint64_t;
 	using ExtraSpecialValue = uint64_t;
 	
+	/// Tag number and the item it annotates, a tag is a prefix of its item and not an item of its own.
+	template<typename Number_>
+	struct TaggedValue {
+		Number_ tag;
+		PObject item;
+	};
+	
+	using TagValue = TaggedValue<uint32_t>;
+	using ExtraTagValue = TaggedValue<uint64_t>;
+	
+	class Encoder;
+	
+	/// Tagged item a registered tag handler decoded into a native value, see TagRegistry.
+	class NativeObject {
+	public:
+		/// Writes the tag and its item.
+		virtual auto encode(Encoder& encoder) const -> void = 0;
+		
+		virtual ~NativeObject() = default;
+	};
+	
+	using NativeValue = std::shared_ptr<NativeObject const>;
+	
+	/// Byte string whose payload was streamed to a BlobHandler instead of being stored.
+	struct BlobValue {
+		uint64_t handle;
+		uint64_t size;
+	};
+	
 	using ObjectValue = std::variant<
 		BoolValue,
 		IntValue,
@@ -57,7 +86,9 @@ namespace cbor {
 		ErrorValue,
 		ExtraIntValue,
 		ExtraTagValue,
-		ExtraSpecialValue
+		ExtraSpecialValue,
+		BlobValue,
+		NativeValue
 	>;
 	
 	template<ObjectType Type>
@@ -67,6 +98,19 @@ namespace cbor {
 		ObjectValue value;
 		uint32_t array_or_map_size = 0;
 		
+		Object() = default;
+		
+		Object(Object const&) = default;
+		
+		Object(Object&&) noexcept = default;
+		
+		auto operator=(Object const&) -> Object& = default;
+		
+		auto operator=(Object&&) noexcept -> Object& = default;
+		
+		/// Releases nested containers from a local stack, so freeing a deeply nested tree does not recurse.
+		~Object();
+		
 		template<ObjectType Type>
 		auto set(ObjectValueType<Type> new_value) -> void;
 		
@@ -117,10 +161,23 @@ namespace cbor {
 			return is<ObjectType::Tag>();
 		}
 		
+		/// Tag or ExtraTag, whatever width the tag number was encoded with.
+		inline auto is_tagged() const -> bool {
+			return is<ObjectType::Tag>() || is<ObjectType::ExtraTag>();
+		}
+		
 		inline auto is_special() const -> bool {
 			return is<ObjectType::Special>();
 		}
 		
+		inline auto is_blob() const -> bool {
+			return is<ObjectType::Blob>();
+		}
+		
+		inline auto is_native() const -> bool {
+			return is<ObjectType::Native>();
+		}
+		
 		inline auto object_type() const -> ObjectType {
 			return static_cast<ObjectType>(value.index());
 		}
@@ -153,10 +210,30 @@ namespace cbor {
 			return as<ObjectType::Tag>();
 		}
 		
+		inline auto tag_number() const -> uint64_t {
+			return is_tag() ? as_tag().tag : as<ObjectType::ExtraTag>().tag;
+		}
+		
+		inline auto tagged_item() const -> PObject const& {
+			return is_tag() ? as_tag().item : as<ObjectType::ExtraTag>().item;
+		}
+		
+		inline auto tagged_item() -> PObject& {
+			return is_tag() ? as<ObjectType::Tag>().item : as<ObjectType::ExtraTag>().item;
+		}
+		
 		inline auto as_special() const -> SpecialValue const& {
 			return as<ObjectType::Special>();
 		}
 		
+		inline auto as_blob() const -> BlobValue const& {
+			return as<ObjectType::Blob>();
+		}
+		
+		inline auto as_native() const -> NativeValue const& {
+			return as<ObjectType::Native>();
+		}
+		
 		template<ObjectType Type>
 		static auto from(ObjectValueType<Type> value, uint32_t size = 0) -> PObject {
 			auto result = std::make_shared<Object>();
@@ -179,6 +256,9 @@ namespace cbor {
 		
 		static auto from_tag(TagValue value) -> PObject;
 		
+		/// Tag node of item, an ExtraTag when the number does not fit 32 bits.
+		static auto from_tag(uint64_t tag, PObject item) -> PObject;
+		
 		static auto from_special(SpecialValue value) -> PObject;
 		
 		static auto create_undefined() -> PObject;
@@ -194,6 +274,13 @@ namespace cbor {
 		static auto from_extra_tag(ExtraTagValue value) -> PObject;
 		
 		static auto from_extra_special(ExtraSpecialValue value) -> PObject;
+		
+		static auto from_blob(BlobValue value) -> PObject;
+		
+		static auto from_native(NativeValue value) -> PObject;
+		
+		/// Estimated heap bytes of this node and its subtree, shared subtrees are counted at every reference.
+		auto memory_usage() const -> size_t;
 	};
 }
 
@@ -0,0 +1,164 @@
+#include "ObjectInterner.hpp"
+
+#include <functional>
+#include <string_view>
+
+namespace cbor {
+	static auto combine(size_t seed, size_t value) -> size_t {
+		return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+	}
+	
+	/// splitmix64 finalizer, child addresses differ only in a few middle bits before it.
+	static auto finish(uint64_t value) -> uint64_t {
+		value ^= value >> 30;
+		value *= 0xbf58476d1ce4e5b9ULL;
+		value ^= value >> 27;
+		value *= 0x94d049bb133111ebULL;
+		value ^= value >> 31;
+		return value;
+	}
+	
+	ObjectInterner::ObjectInterner(size_t capacity, size_t max_items, size_t max_string) :
+		_max_items(max_items), _max_string(max_string), _hits(0) {
+		size_t size = bucket_size;
+		while(size < capacity) {
+			size <<= 1;
+		}
+		_table.resize(size);
+	}
+	
+	auto ObjectInterner::hash(Object const& value, size_t& result) const -> bool {
+		result = combine(0, value.value.index());
+		switch(value.object_type()) {
+			case ObjectType::Bool:
+				result = combine(result, value.as_bool());
+				return true;
+			case ObjectType::Int:
+				result = combine(result, std::hash<int64_t>()(value.as_int()));
+				return true;
+			case ObjectType::Tag:
+			case ObjectType::ExtraTag:
+				result = combine(combine(result, std::hash<uint64_t>()(value.tag_number())), std::hash<Object*>()(value.tagged_item().get()));
+				return true;
+			case ObjectType::Special:
+				result = combine(result, value.as_special());
+				return true;
+			case ObjectType::ExtraInt: {
+				auto const& extra = value.as<ObjectType::ExtraInt>();
+				result = combine(combine(result, extra.first), std::hash<uint64_t>()(extra.second));
+				return true;
+			}
+			case ObjectType::ExtraSpecial:
+				result = combine(result, std::hash<uint64_t>()(value.as<ObjectType::ExtraSpecial>()));
+				return true;
+			case ObjectType::Null:
+			case ObjectType::Undefined:
+				return true;
+			case ObjectType::String: {
+				auto const& string_value = value.as_string();
+				if(string_value.size() > _max_string) {
+					return false;
+				}
+				result = combine(result, std::hash<std::string_view>()(string_value));
+				return true;
+			}
+			case ObjectType::Bytes: {
+				auto const& bytes_value = value.as_bytes();
+				if(bytes_value.size() > _max_string) {
+					return false;
+				}
+				result = combine(result, std::hash<std::string_view>()({bytes_value.data(), bytes_value.size()}));
+				return true;
+			}
+			case ObjectType::Array: {
+				auto const& array_value = value.as_array();
+				if(array_value.size() > _max_items) {
+					return false;
+				}
+				for(auto const& item: array_value) {
+					result = combine(result, std::hash<Object*>()(item.get()));
+				}
+				return true;
+			}
+			case ObjectType::Map: {
+				auto const& map_value = value.as_map();
+				if(map_value.size() > _max_items) {
+					return false;
+				}
+				for(auto const& p: map_value) {
+					result = combine(combine(result, std::hash<std::string>()(p.first)), std::hash<Object*>()(p.second.get()));
+				}
+				return true;
+			}
+			default:
+				return false;
+		}
+	}
+	
+	auto ObjectInterner::equal(Object const& first, Object const& second) -> bool {
+		if(first.value.index() != second.value.index()) {
+			return false;
+		}
+		switch(first.object_type()) {
+			case ObjectType::Bool:
+				return first.as_bool() == second.as_bool();
+			case ObjectType::Int:
+				return first.as_int() == second.as_int();
+			case ObjectType::Tag:
+			case ObjectType::ExtraTag:
+				// the tagged item is interned, comparing the pointers is enough
+				return first.tag_number() == second.tag_number() && first.tagged_item() == second.tagged_item();
+			case ObjectType::Special:
+				return first.as_special() == second.as_special();
+			case ObjectType::ExtraInt:
+				return first.as<ObjectType::ExtraInt>() == second.as<ObjectType::ExtraInt>();
+			case ObjectType::ExtraSpecial:
+				return first.as<ObjectType::ExtraSpecial>() == second.as<ObjectType::ExtraSpecial>();
+			case ObjectType::Null:
+			case ObjectType::Undefined:
+				return true;
+			case ObjectType::String:
+				return first.as_string() == second.as_string();
+			case ObjectType::Bytes:
+				return first.as_bytes() == second.as_bytes();
+			case ObjectType::Array:
+				// children are interned, comparing the pointers is enough
+				return first.as_array() == second.as_array();
+			case ObjectType::Map:
+				return first.as_map() == second.as_map();
+			default:
+				return false;
+		}
+	}
+	
+	auto ObjectInterner::intern(PObject const& value) -> PObject {
+		size_t value_hash;
+		if(!value || !hash(*value, value_hash)) {
+			return value;
+		}
+		auto bucket = _table.data() + (finish(value_hash) & (_table.size() / bucket_size - 1)) * bucket_size;
+		for(size_t i = 0; i < bucket_size && bucket[i]; ++i) {
+			if(equal(*bucket[i], *value)) {
+				++_hits;
+				return bucket[i];
+			}
+		}
+		// the newest entry goes first, a full bucket drops its oldest one
+		for(size_t i = bucket_size - 1; i > 0; --i) {
+			bucket[i] = std::move(bucket[i - 1]);
+		}
+		bucket[0] = value;
+		return value;
+	}
+	
+	auto ObjectInterner::hits() const -> size_t {
+		return _hits;
+	}
+	
+	auto ObjectInterner::clear() -> void {
+		for(auto& slot: _table) {
+			slot.reset();
+		}
+		_hits = 0;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../Object/Object.hpp"
+
+namespace cbor {
+	/// Bounded table of shared immutable nodes: scalars, strings and bytes up to max_string bytes,
+	/// arrays and maps up to max_items items and tags. Containers and tags are compared by the identity
+	/// of their children, so children have to be interned first. Entries live in buckets of four,
+	/// a full bucket drops its oldest entry.
+	/// Interned trees share nodes, EncodeCache cannot encode them.
+	class ObjectInterner {
+	public:
+		ObjectInterner(size_t capacity = 4096, size_t max_items = 16, size_t max_string = 256);
+		
+		/// Returns an equal node seen before, or remembers and returns value.
+		auto intern(PObject const& value) -> PObject;
+		
+		auto hits() const -> size_t;
+		
+		auto clear() -> void;
+	
+	private:
+		/// Returns false for nodes that are not interned.
+		auto hash(Object const& value, size_t& result) const -> bool;
+		
+		static auto equal(Object const& first, Object const& second) -> bool;
+		
+		static constexpr size_t bucket_size = 4;
+		
+		std::vector<PObject> _table;
+		size_t _max_items;
+		size_t _max_string;
+		size_t _hits;
+	};
+}
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <vector>
 #include <string>
+#include <cstdint>
 
 namespace cbor {
 	auto Output::bytes() const -> std::vector<unsigned char> {
@@ -11,4 +12,12 @@ namespace cbor {
 		memcpy(result.data(), data(), size());
 		return result;
 	}
+	
+	auto Output::put_reference(const unsigned char* data, size_t size) -> void {
+		put_bytes(data, size);
+	}
+	
+	auto Output::remaining_capacity() const -> size_t {
+		return SIZE_MAX;
+	}
 }
\ No newline at end of file
@@ -18,19 +18,28 @@
 
 #include <vector>
 #include <string>
+#include <cstddef>
 
 namespace cbor {
 	class Output {
 	public:
 		virtual auto data() const -> unsigned char* = 0;
 		
-		virtual auto size() const -> unsigned int = 0;
+		virtual auto size() const -> size_t = 0;
 		
 		virtual auto bytes() const -> std::vector<unsigned char>;
 		
 		virtual auto put_byte(unsigned char value) -> void = 0;
 		
-		virtual auto put_bytes(const unsigned char* data, int size) -> void = 0;
+		virtual auto put_bytes(const unsigned char* data, size_t size) -> void = 0;
+		
+		/// Writes bytes the caller keeps alive until the output is consumed, outputs may store a reference instead of a copy.
+		virtual auto put_reference(const unsigned char* data, size_t size) -> void;
+		
+		/// Number of bytes that can still be written, unbounded outputs return SIZE_MAX.
+		virtual auto remaining_capacity() const -> size_t;
+		
+		virtual ~Output() = default;
 	};
 }
 
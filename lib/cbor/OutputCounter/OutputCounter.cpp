@@ -0,0 +1,28 @@
+#include "OutputCounter.hpp"
+#include "../Exceptions/Exceptions.hpp"
+
+namespace cbor {
+	OutputCounter::OutputCounter() :
+		_size(0) {
+	}
+	
+	auto OutputCounter::data() const -> unsigned char* {
+		throw_exception(OutputException("counting output stores no data"));
+	}
+	
+	auto OutputCounter::size() const -> size_t {
+		return _size;
+	}
+	
+	auto OutputCounter::put_byte(unsigned char) -> void {
+		++_size;
+	}
+	
+	auto OutputCounter::put_bytes(unsigned char const*, size_t size) -> void {
+		_size += size;
+	}
+	
+	auto OutputCounter::reset() -> void {
+		_size = 0;
+	}
+}
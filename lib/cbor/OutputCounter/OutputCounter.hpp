@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../Output/Output.hpp"
+
+namespace cbor {
+	/// Output that only counts the bytes written to it, to size a buffer before encoding.
+	class OutputCounter : public Output {
+	public:
+		OutputCounter();
+		
+		/// Not available, nothing is stored.
+		auto data() const -> unsigned char* override;
+		
+		auto size() const -> size_t override;
+		
+		auto put_byte(unsigned char value) -> void override;
+		
+		auto put_bytes(unsigned char const* data, size_t size) -> void override;
+		
+		auto reset() -> void;
+	
+	private:
+		size_t _size;
+	};
+}
@@ -20,49 +20,133 @@
 #include <stdlib.h>
 
 namespace cbor {
-	OutputDynamic::OutputDynamic(unsigned int inital_capacity) {
-		init(inital_capacity);
+	OutputDynamic::OutputDynamic(size_t inital_capacity, Allocator& allocator) :
+		_buffer(_inline), _capacity(inline_capacity), _offset(0), _allocator(&allocator) {
+		reserve(inital_capacity);
 	}
 	
-	OutputDynamic::OutputDynamic() {
-		init(256);
+	OutputDynamic::OutputDynamic(Allocator& allocator) :
+		_buffer(_inline), _capacity(inline_capacity), _offset(0), _allocator(&allocator) {
 	}
 	
-	auto OutputDynamic::init(unsigned int inital_capacity) -> void {
-		this->_capacity = inital_capacity;
-		this->_buffer = new unsigned char[inital_capacity];
-		this->_offset = 0;
+	OutputDynamic::OutputDynamic() :
+		_buffer(_inline), _capacity(inline_capacity), _offset(0), _allocator(&Allocator::standard()) {
+	}
+	
+	OutputDynamic::OutputDynamic(OutputDynamic&& other) noexcept :
+		_buffer(_inline), _capacity(inline_capacity), _offset(0), _allocator(other._allocator) {
+		take(other);
+	}
+	
+	auto OutputDynamic::operator=(OutputDynamic&& other) noexcept -> OutputDynamic& {
+		if(this != &other) {
+			free_buffer();
+			_allocator = other._allocator;
+			take(other);
+		}
+		return *this;
+	}
+	
+	auto OutputDynamic::take(OutputDynamic& other) -> void {
+		if(other.is_inline()) {
+			_buffer = _inline;
+			_capacity = inline_capacity;
+			memcpy(_inline, other._inline, other._offset);
+		} else {
+			_buffer = other._buffer;
+			_capacity = other._capacity;
+		}
+		_offset = other._offset;
+		other._buffer = other._inline;
+		other._capacity = inline_capacity;
+		other._offset = 0;
+	}
+	
+	auto OutputDynamic::is_inline() const -> bool {
+		return _buffer == _inline;
+	}
+	
+	auto OutputDynamic::free_buffer() -> void {
+		if(!is_inline()) {
+			_allocator->deallocate(_buffer, _capacity);
+		}
+		_buffer = _inline;
+		_capacity = inline_capacity;
+		_offset = 0;
 	}
 	
 	auto OutputDynamic::data() const -> unsigned char* {
 		return _buffer;
 	}
 	
-	auto OutputDynamic::size() const -> unsigned int {
+	auto OutputDynamic::size() const -> size_t {
 		return _offset;
 	}
 	
-	auto OutputDynamic::put_byte(unsigned char value) -> void {
-		if(_offset < _capacity) {
-			_buffer[_offset++] = value;
+	auto OutputDynamic::capacity() const -> size_t {
+		return _capacity;
+	}
+	
+	auto OutputDynamic::grow(size_t required) -> void {
+		auto new_capacity = _capacity * 2;
+		while(new_capacity < required) {
+			new_capacity *= 2;
+		}
+		if(is_inline()) {
+			auto buffer = _allocator->allocate(new_capacity);
+			memcpy(buffer, _inline, _offset);
+			_buffer = buffer;
 		} else {
-			_capacity *= 2;
-			_buffer = (unsigned char*)realloc(_buffer, _capacity);
-			_buffer[_offset++] = value;
+			_buffer = _allocator->reallocate(_buffer, _capacity, _offset, new_capacity);
+		}
+		_capacity = new_capacity;
+	}
+	
+	auto OutputDynamic::put_byte(unsigned char value) -> void {
+		if(_offset == _capacity) {
+			grow(_offset + 1);
 		}
+		_buffer[_offset++] = value;
 	}
 	
-	auto OutputDynamic::put_bytes(unsigned char const* data, int size) -> void {
-		while(_offset + size > _capacity) {
-			_capacity *= 2;
-			_buffer = (unsigned char*)realloc(_buffer, _capacity);
+	auto OutputDynamic::put_bytes(unsigned char const* data, size_t size) -> void {
+		// empty byte strings may come with a null pointer, which memcpy does not accept
+		if(size == 0) {
+			return;
+		}
+		if(size > _capacity - _offset) {
+			grow(_offset + size);
 		}
-		
 		memcpy(_buffer + _offset, data, size);
 		_offset += size;
 	}
 	
+	auto OutputDynamic::reset() -> void {
+		_offset = 0;
+	}
+	
+	auto OutputDynamic::reserve(size_t capacity) -> void {
+		if(capacity > _capacity) {
+			grow(capacity);
+		}
+	}
+	
+	auto OutputDynamic::release() -> Buffer {
+		if(is_inline()) {
+			auto buffer = _allocator->allocate(_offset > 0 ? _offset : 1);
+			memcpy(buffer, _inline, _offset);
+			Buffer result(buffer, _offset, _offset > 0 ? _offset : 1, *_allocator);
+			_offset = 0;
+			return result;
+		}
+		Buffer result(_buffer, _offset, _capacity, *_allocator);
+		_buffer = _inline;
+		_capacity = inline_capacity;
+		_offset = 0;
+		return result;
+	}
+	
 	OutputDynamic::~OutputDynamic() {
-		delete _buffer;
+		free_buffer();
 	}
 }
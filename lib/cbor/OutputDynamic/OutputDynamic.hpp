@@ -17,31 +17,61 @@
 #pragma once
 
 #include "../Output/Output.hpp"
+#include "../Allocator/Allocator.hpp"
 #include <vector>
 
 namespace cbor {
 	class OutputDynamic : public Output {
 	public:
-		OutputDynamic(unsigned int inital_capacity);
+		static constexpr size_t inline_capacity = 128;
+		
+		OutputDynamic(size_t inital_capacity, Allocator& allocator = Allocator::standard());
+		
+		OutputDynamic(Allocator& allocator);
 		
 		OutputDynamic();
 		
+		OutputDynamic(OutputDynamic&& other) noexcept;
+		
+		OutputDynamic(OutputDynamic const&) = delete;
+		
+		auto operator=(OutputDynamic&& other) noexcept -> OutputDynamic&;
+		
+		auto operator=(OutputDynamic const&) -> OutputDynamic& = delete;
+		
 		auto data() const -> unsigned char* override;
 		
-		auto size() const -> unsigned int override;
+		auto size() const -> size_t override;
+		
+		auto capacity() const -> size_t;
 		
 		auto put_byte(unsigned char value) -> void override;
 		
-		auto put_bytes(unsigned char const* data, int size) -> void override;
+		auto put_bytes(unsigned char const* data, size_t size) -> void override;
+		
+		/// Drops the written bytes but keeps the allocated capacity for the next message.
+		auto reset() -> void;
+		
+		auto reserve(size_t capacity) -> void;
+		
+		/// Hands the written bytes over without copying, copies only when they are still in the inline storage.
+		auto release() -> Buffer;
 		
 		~OutputDynamic();
 	
 	private:
-		auto init(unsigned int inital_capacity) -> void;
-	
+		auto is_inline() const -> bool;
+		
+		auto grow(size_t required) -> void;
+		
+		auto take(OutputDynamic& other) -> void;
+		
+		auto free_buffer() -> void;
+		
+		unsigned char _inline[inline_capacity];
 		unsigned char* _buffer;
-		unsigned int _capacity;
-		unsigned int _offset;
+		size_t _capacity;
+		size_t _offset;
+		Allocator* _allocator;
 	};
 }
-
@@ -0,0 +1,115 @@
+#include "OutputMapped.hpp"
+#include "../Exceptions/Exceptions.hpp"
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace cbor {
+	static auto system_error(std::string const& what) -> OutputException {
+		return OutputException(what + ": " + strerror(errno));
+	}
+	
+	OutputMapped::OutputMapped(std::string const& path, size_t initial_capacity, bool async_sync) :
+		_fd(-1), _buffer(nullptr), _capacity(initial_capacity > 0 ? initial_capacity : 1), _offset(0), _async_sync(async_sync) {
+		_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if(_fd < 0) {
+			throw_exception(system_error("open failed"));
+		}
+		if(::ftruncate(_fd, (off_t)_capacity) != 0) {
+			::close(_fd);
+			throw_exception(system_error("ftruncate failed"));
+		}
+		auto mapping = ::mmap(nullptr, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+		if(mapping == MAP_FAILED) {
+			::close(_fd);
+			throw_exception(system_error("mmap failed"));
+		}
+		_buffer = (unsigned char*)mapping;
+	}
+	
+	auto OutputMapped::data() const -> unsigned char* {
+		return _buffer;
+	}
+	
+	auto OutputMapped::size() const -> size_t {
+		return _offset;
+	}
+	
+	auto OutputMapped::capacity() const -> size_t {
+		return _capacity;
+	}
+	
+	auto OutputMapped::grow(size_t required) -> void {
+		if(_fd < 0) {
+			throw_exception(OutputException("mapped output is closed"));
+		}
+		if(_async_sync) {
+			sync();
+		}
+		auto new_capacity = _capacity * 2;
+		while(new_capacity < required) {
+			new_capacity *= 2;
+		}
+		if(::ftruncate(_fd, (off_t)new_capacity) != 0) {
+			throw_exception(system_error("ftruncate failed"));
+		}
+#ifdef __linux__
+		auto mapping = ::mremap(_buffer, _capacity, new_capacity, MREMAP_MAYMOVE);
+#else
+		::munmap(_buffer, _capacity);
+		auto mapping = ::mmap(nullptr, new_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+#endif
+		if(mapping == MAP_FAILED) {
+			throw_exception(system_error("mremap failed"));
+		}
+		_buffer = (unsigned char*)mapping;
+		_capacity = new_capacity;
+	}
+	
+	auto OutputMapped::put_byte(unsigned char value) -> void {
+		if(_offset == _capacity) {
+			grow(_offset + 1);
+		}
+		_buffer[_offset++] = value;
+	}
+	
+	auto OutputMapped::put_bytes(unsigned char const* data, size_t size) -> void {
+		if(size > _capacity - _offset) {
+			grow(_offset + size);
+		}
+		memcpy(_buffer + _offset, data, size);
+		_offset += size;
+	}
+	
+	auto OutputMapped::sync() -> void {
+		if(_buffer != nullptr && ::msync(_buffer, _offset, MS_ASYNC) != 0) {
+			throw_exception(system_error("msync failed"));
+		}
+	}
+	
+	auto OutputMapped::close() -> void {
+		if(_fd < 0) {
+			return;
+		}
+		::munmap(_buffer, _capacity);
+		_buffer = nullptr;
+		auto truncated = ::ftruncate(_fd, (off_t)_offset) == 0;
+		auto closed = ::close(_fd) == 0;
+		_fd = -1;
+		_capacity = 0;
+		if(!truncated || !closed) {
+			throw_exception(system_error("closing mapped output failed"));
+		}
+	}
+	
+	OutputMapped::~OutputMapped() {
+		if(_fd >= 0) {
+			::munmap(_buffer, _capacity);
+			(void)::ftruncate(_fd, (off_t)_offset);
+			::close(_fd);
+		}
+	}
+}
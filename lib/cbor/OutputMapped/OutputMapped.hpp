@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../Output/Output.hpp"
+#include <string>
+
+namespace cbor {
+	/// Output writing into a memory-mapped file that grows with ftruncate and mremap, truncated to the written size on close.
+	class OutputMapped : public Output {
+	public:
+		static constexpr size_t default_capacity = (size_t)64 << 20;
+		
+		OutputMapped(std::string const& path, size_t initial_capacity = default_capacity, bool async_sync = false);
+		
+		OutputMapped(OutputMapped const&) = delete;
+		
+		auto operator=(OutputMapped const&) -> OutputMapped& = delete;
+		
+		/// Start of the mapping, moves when the file grows.
+		auto data() const -> unsigned char* override;
+		
+		auto size() const -> size_t override;
+		
+		auto capacity() const -> size_t;
+		
+		auto put_byte(unsigned char value) -> void override;
+		
+		auto put_bytes(unsigned char const* data, size_t size) -> void override;
+		
+		/// Schedules writeback of the written bytes with msync(MS_ASYNC).
+		auto sync() -> void;
+		
+		auto close() -> void;
+		
+		~OutputMapped();
+	
+	private:
+		auto grow(size_t required) -> void;
+		
+		int _fd;
+		unsigned char* _buffer;
+		size_t _capacity;
+		size_t _offset;
+		bool _async_sync;
+	};
+}
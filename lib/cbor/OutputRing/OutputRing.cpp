@@ -0,0 +1,53 @@
+#include "OutputRing.hpp"
+#include "../Exceptions/Exceptions.hpp"
+
+#include <string.h>
+#include <algorithm>
+#include <thread>
+
+namespace cbor {
+	OutputRing::OutputRing(RingBuffer& ring) :
+		_ring(&ring), _data(ring.data()), _mask(ring.capacity - 1),
+		_write(ring.tail.load(std::memory_order_relaxed)), _committed(_write), _head(ring.head.load(std::memory_order_acquire)) {
+	}
+	
+	auto OutputRing::data() const -> unsigned char* {
+		throw_exception(OutputException("ring output is not contiguous"));
+	}
+	
+	auto OutputRing::size() const -> size_t {
+		return _write - _committed;
+	}
+	
+	auto OutputRing::wait_space(uint64_t count) -> void {
+		if(_write + count - _committed > _ring->capacity) {
+			throw_exception(OutputException("item larger than ring buffer"));
+		}
+		while(_write + count - _head > _ring->capacity) {
+			_head = _ring->head.load(std::memory_order_acquire);
+			if(_write + count - _head > _ring->capacity) {
+				std::this_thread::yield();
+			}
+		}
+	}
+	
+	auto OutputRing::put_byte(unsigned char value) -> void {
+		wait_space(1);
+		_data[_write & _mask] = value;
+		++_write;
+	}
+	
+	auto OutputRing::put_bytes(unsigned char const* data, size_t size) -> void {
+		wait_space(size);
+		auto index = _write & _mask;
+		auto first = std::min<uint64_t>(size, _ring->capacity - index);
+		memcpy(_data + index, data, first);
+		memcpy(_data, data + first, size - first);
+		_write += size;
+	}
+	
+	auto OutputRing::commit() -> void {
+		_ring->tail.store(_write, std::memory_order_release);
+		_committed = _write;
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../Output/Output.hpp"
+#include "../RingBuffer/RingBuffer.hpp"
+
+namespace cbor {
+	/// Producer end of a RingBuffer, bytes become visible to the consumer on commit().
+	/// Waits for the consumer when the ring is full, an item has to fit into the ring.
+	class OutputRing : public Output {
+	public:
+		OutputRing(RingBuffer& ring);
+		
+		/// Not available, the ring wraps around.
+		auto data() const -> unsigned char* override;
+		
+		/// Bytes written since the last commit.
+		auto size() const -> size_t override;
+		
+		auto put_byte(unsigned char value) -> void override;
+		
+		auto put_bytes(unsigned char const* data, size_t size) -> void override;
+		
+		/// Publishes the written items to the consumer.
+		auto commit() -> void;
+	
+	private:
+		auto wait_space(uint64_t count) -> void;
+		
+		RingBuffer* _ring;
+		uint8_t* _data;
+		uint64_t _mask;
+		uint64_t _write;
+		uint64_t _committed;
+		uint64_t _head;
+	};
+}
@@ -0,0 +1,144 @@
+#include "OutputSegmented.hpp"
+#include "../Exceptions/Exceptions.hpp"
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <algorithm>
+
+namespace cbor {
+	OutputSegmented::OutputSegmented(size_t chunk_size, size_t reference_threshold, Allocator& allocator) :
+		_chunk_size(chunk_size), _reference_threshold(reference_threshold), _allocator(&allocator),
+		_used_chunks(0), _chunk(nullptr), _chunk_offset(chunk_size), _open(false), _size(0),
+		_flushed_slices(0), _flushed_offset(0) {
+	}
+	
+	auto OutputSegmented::data() const -> unsigned char* {
+		throw_exception(OutputException("segmented output is not contiguous"));
+	}
+	
+	auto OutputSegmented::size() const -> size_t {
+		return _size;
+	}
+	
+	auto OutputSegmented::bytes() const -> std::vector<unsigned char> {
+		std::vector<unsigned char> result(_size);
+		size_t offset = 0;
+		for(auto const& slice: _slices) {
+			memcpy(result.data() + offset, slice.data, slice.size);
+			offset += slice.size;
+		}
+		return result;
+	}
+	
+	auto OutputSegmented::slices() const -> std::vector<Slice> const& {
+		return _slices;
+	}
+	
+	auto OutputSegmented::next_chunk() -> void {
+		if(_used_chunks == _chunks.size()) {
+			_chunks.push_back(_allocator->allocate(_chunk_size));
+		}
+		_chunk = _chunks[_used_chunks++];
+		_chunk_offset = 0;
+		_open = false;
+	}
+	
+	auto OutputSegmented::put_byte(unsigned char value) -> void {
+		if(_chunk_offset == _chunk_size) {
+			next_chunk();
+		}
+		if(!_open) {
+			_slices.push_back({_chunk + _chunk_offset, 0});
+			_open = true;
+		}
+		_chunk[_chunk_offset++] = value;
+		++_slices.back().size;
+		++_size;
+	}
+	
+	auto OutputSegmented::put_bytes(const unsigned char* data, size_t size) -> void {
+		while(size > 0) {
+			if(_chunk_offset == _chunk_size) {
+				next_chunk();
+			}
+			if(!_open) {
+				_slices.push_back({_chunk + _chunk_offset, 0});
+				_open = true;
+			}
+			auto count = std::min(size, _chunk_size - _chunk_offset);
+			memcpy(_chunk + _chunk_offset, data, count);
+			_chunk_offset += count;
+			_slices.back().size += count;
+			_size += count;
+			data += count;
+			size -= count;
+		}
+	}
+	
+	auto OutputSegmented::put_reference(const unsigned char* data, size_t size) -> void {
+		if(size == 0 || size < _reference_threshold) {
+			put_bytes(data, size);
+			return;
+		}
+		_slices.push_back({data, size});
+		_open = false;
+		_size += size;
+	}
+	
+	auto OutputSegmented::reset() -> void {
+		for(size_t i = 1; i < _chunks.size(); ++i) {
+			_allocator->deallocate(_chunks[i], _chunk_size);
+		}
+		if(_chunks.size() > 1) {
+			_chunks.resize(1);
+		}
+		_slices.clear();
+		_used_chunks = 0;
+		_chunk = nullptr;
+		_chunk_offset = _chunk_size;
+		_open = false;
+		_size = 0;
+		_flushed_slices = 0;
+		_flushed_offset = 0;
+	}
+	
+	auto OutputSegmented::flush_to_fd(int fd) -> bool {
+		std::vector<iovec> iov;
+		auto& index = _flushed_slices;
+		auto& offset = _flushed_offset;
+		while(index < _slices.size()) {
+			iov.clear();
+			for(size_t i = index; i < _slices.size() && iov.size() < IOV_MAX; ++i) {
+				auto skip = i == index ? offset : 0;
+				iov.push_back({(void*)(_slices[i].data + skip), _slices[i].size - skip});
+			}
+			auto written = ::writev(fd, iov.data(), (int)iov.size());
+			if(written < 0) {
+				if(errno == EINTR) {
+					continue;
+				}
+				if(errno == EAGAIN || errno == EWOULDBLOCK) {
+					return false;
+				}
+				throw_exception(OutputException(std::string("writev failed: ") + strerror(errno)));
+			}
+			auto left = (size_t)written;
+			while(index < _slices.size() && left >= _slices[index].size - offset) {
+				left -= _slices[index].size - offset;
+				offset = 0;
+				++index;
+			}
+			offset += left;
+		}
+		reset();
+		return true;
+	}
+	
+	OutputSegmented::~OutputSegmented() {
+		for(auto chunk: _chunks) {
+			_allocator->deallocate(chunk, _chunk_size);
+		}
+	}
+}
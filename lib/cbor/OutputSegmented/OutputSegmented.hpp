@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../Output/Output.hpp"
+#include "../Allocator/Allocator.hpp"
+#include <vector>
+
+namespace cbor {
+	struct Slice {
+		const unsigned char* data;
+		size_t size;
+	};
+	
+	/// Output made of fixed-size chunks that are never moved, large referenced payloads are kept as slices of caller memory.
+	class OutputSegmented : public Output {
+	public:
+		OutputSegmented(size_t chunk_size = 65536, size_t reference_threshold = 4096, Allocator& allocator = Allocator::standard());
+		
+		OutputSegmented(OutputSegmented const&) = delete;
+		
+		auto operator=(OutputSegmented const&) -> OutputSegmented& = delete;
+		
+		/// Not available, the written bytes are not contiguous, use slices() or bytes().
+		auto data() const -> unsigned char* override;
+		
+		auto size() const -> size_t override;
+		
+		auto bytes() const -> std::vector<unsigned char> override;
+		
+		auto put_byte(unsigned char value) -> void override;
+		
+		auto put_bytes(const unsigned char* data, size_t size) -> void override;
+		
+		auto put_reference(const unsigned char* data, size_t size) -> void override;
+		
+		auto slices() const -> std::vector<Slice> const&;
+		
+		/// Drops the written bytes, keeps the first chunk for reuse.
+		auto reset() -> void;
+		
+		/// Writes everything to fd with writev and resets the output, returns false if a non-blocking fd would block.
+		/// The bytes already written are remembered, the next call continues after them.
+		auto flush_to_fd(int fd) -> bool;
+		
+		~OutputSegmented();
+	
+	private:
+		auto next_chunk() -> void;
+		
+		size_t _chunk_size;
+		size_t _reference_threshold;
+		Allocator* _allocator;
+		std::vector<unsigned char*> _chunks;
+		std::vector<Slice> _slices;
+		size_t _used_chunks;
+		unsigned char* _chunk;
+		size_t _chunk_offset;
+		bool _open;
+		size_t _size;
+		size_t _flushed_slices;
+		size_t _flushed_offset;
+	};
+}
@@ -0,0 +1,47 @@
+#include "OutputSpan.hpp"
+#include "../Exceptions/Exceptions.hpp"
+
+#include <string.h>
+
+namespace cbor {
+	OutputSpan::OutputSpan(void* data, size_t capacity) :
+		_buffer((unsigned char*)data), _capacity(capacity), _offset(0) {
+	}
+	
+	auto OutputSpan::data() const -> unsigned char* {
+		return _buffer;
+	}
+	
+	auto OutputSpan::size() const -> size_t {
+		return _offset;
+	}
+	
+	auto OutputSpan::capacity() const -> size_t {
+		return _capacity;
+	}
+	
+	auto OutputSpan::remaining_capacity() const -> size_t {
+		return _capacity - _offset;
+	}
+	
+	auto OutputSpan::put_byte(unsigned char value) -> void {
+		if(_offset < _capacity) {
+			_buffer[_offset++] = value;
+		} else {
+			throw_exception(OutputException("buffer overflow error"));
+		}
+	}
+	
+	auto OutputSpan::put_bytes(unsigned char const* data, size_t size) -> void {
+		if(size <= _capacity - _offset) {
+			memcpy(_buffer + _offset, data, size);
+			_offset += size;
+		} else {
+			throw_exception(OutputException("buffer overflow error"));
+		}
+	}
+	
+	auto OutputSpan::reset() -> void {
+		_offset = 0;
+	}
+}
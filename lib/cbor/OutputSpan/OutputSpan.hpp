@@ -0,0 +1,30 @@
+#pragma once
+
+#include "../Output/Output.hpp"
+
+namespace cbor {
+	/// Output writing into memory owned by the caller, throws OutputException when it is full.
+	class OutputSpan : public Output {
+	public:
+		OutputSpan(void* data, size_t capacity);
+		
+		auto data() const -> unsigned char* override;
+		
+		auto size() const -> size_t override;
+		
+		auto capacity() const -> size_t;
+		
+		auto remaining_capacity() const -> size_t override;
+		
+		auto put_byte(unsigned char value) -> void override;
+		
+		auto put_bytes(unsigned char const* data, size_t size) -> void override;
+		
+		auto reset() -> void;
+	
+	protected:
+		unsigned char* _buffer;
+		size_t _capacity;
+		size_t _offset;
+	};
+}
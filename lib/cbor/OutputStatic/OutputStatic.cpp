@@ -15,43 +15,13 @@
 */
 
 #include "OutputStatic.hpp"
-#include "../Exceptions/Exceptions.hpp"
-
-#include <string.h>
 
 namespace cbor {
-	OutputStatic::OutputStatic(unsigned int capacity) {
-		this->_capacity = capacity;
-		this->_buffer = new unsigned char[capacity];
-		this->_offset = 0;
-	}
-	
-	auto OutputStatic::data() const -> unsigned char* {
-		return _buffer;
-	}
-	
-	auto OutputStatic::size() const -> unsigned int {
-		return _offset;
-	}
-	
-	auto OutputStatic::put_byte(unsigned char value) -> void {
-		if(_offset < _capacity) {
-			_buffer[_offset++] = value;
-		} else {
-			throw OutputException("buffer overflow error");
-		}
-	}
-	
-	auto OutputStatic::put_bytes(unsigned char const* data, int size) -> void {
-		if(_offset + size - 1 < _capacity) {
-			memcpy(_buffer + _offset, data, size);
-			_offset += size;
-		} else {
-			throw OutputException("buffer overflow error");
-		}
+	OutputStatic::OutputStatic(size_t capacity) :
+		OutputSpan(new unsigned char[capacity], capacity) {
 	}
 	
 	OutputStatic::~OutputStatic() {
-		delete _buffer;
+		delete[] _buffer;
 	}
 }
@@ -16,27 +16,17 @@
 
 #pragma once
 
-#include "../Output/Output.hpp"
+#include "../OutputSpan/OutputSpan.hpp"
 
 namespace cbor {
-	class OutputStatic : public Output {
+	class OutputStatic : public OutputSpan {
 	public:
-		OutputStatic(unsigned int capacity);
+		OutputStatic(size_t capacity);
 		
-		auto data() const -> unsigned char* override;
+		OutputStatic(OutputStatic const&) = delete;
 		
-		auto size() const -> unsigned int override;
-		
-		auto put_byte(unsigned char value) -> void override;
-		
-		auto put_bytes(unsigned char const* data, int size) -> void override;
+		auto operator=(OutputStatic const&) -> OutputStatic& = delete;
 		
 		~OutputStatic();
-	
-	private:
-		unsigned char* _buffer;
-		unsigned int _capacity;
-		unsigned int _offset;
 	};
 }
-
@@ -0,0 +1,122 @@
+#include "ParallelDecoder.hpp"
+#include "../Decoder/Decoder.hpp"
+#include "../Reader/Reader.hpp"
+#include "../TaskPool/TaskPool.hpp"
+
+#include <limits.h>
+
+namespace cbor {
+	/// Skips one item as Decoder counts them, a tag is a prefix of the item after it.
+	static auto skip_item(Reader& reader) -> void {
+		// a counter of pending items instead of recursion, as deep nesting would exhaust the stack
+		uint64_t pending = 1;
+		while(pending > 0) {
+			--pending;
+			auto head = reader.read_head();
+			uint64_t items = 0;
+			switch(head.major_type) {
+				case 2: // bytes
+				case 3: // string
+					reader.skip(head);
+					break;
+				case 4: // array
+					items = head.value;
+					break;
+				case 5: // map
+					items = head.value > UINT64_MAX / 2 ? UINT64_MAX : head.value * 2;
+					break;
+				case 6: // tag
+					items = 1;
+					break;
+				default:
+					break;
+			}
+			// saturates, such counts cannot be backed by input and end with unexpected end of input
+			pending = items > UINT64_MAX - pending ? UINT64_MAX : pending + items;
+		}
+	}
+	
+	struct DecodeRun {
+		int begin;
+		int end;
+		size_t first;
+		size_t count;
+		std::vector<std::pair<std::string, PObject> > entries;
+	};
+	
+	auto decode_parallel(const void* data, size_t size, size_t thread_count, size_t tasks_per_thread) -> PObject {
+		if(size > INT_MAX) {
+			throw_exception(DecodeException("input too large"));
+		}
+		if(thread_count == 0) {
+			thread_count = default_thread_count();
+		}
+		auto bytes = (uint8_t*)data;
+		
+		Input input(bytes, (int)size);
+		Reader reader(input);
+		auto head = input.is_empty() ? Head{} : reader.read_head();
+		auto is_container = (head.major_type == 4 || head.major_type == 5);
+		auto run_count = std::min<uint64_t>(head.value, thread_count * std::max<size_t>(tasks_per_thread, 1));
+		if(thread_count == 1 || !is_container || run_count < 2) {
+			Input whole(bytes, (int)size);
+			return Decoder(whole).run();
+		}
+		
+		auto is_map = head.major_type == 5;
+		auto item_count = head.value;
+		std::vector<DecodeRun> runs(run_count);
+		size_t first = 0;
+		for(size_t i = 0; i < run_count; ++i) {
+			auto end = item_count * (i + 1) / run_count;
+			runs[i].begin = input.offset();
+			runs[i].first = first;
+			runs[i].count = end - first;
+			for(; first < end; ++first) {
+				skip_item(reader);
+				if(is_map) {
+					skip_item(reader);
+				}
+			}
+			runs[i].end = input.offset();
+		}
+		if(!input.is_empty()) {
+			throw_exception(DecodeException("multiple cbor object when decoding"));
+		}
+		
+		auto result = is_map ? Object::create_map(item_count) : Object::create_array(item_count);
+		if(!is_map) {
+			result->as<ObjectType::Array>().resize(item_count);
+		}
+		run_tasks(runs.size(), thread_count, [&](size_t index) {
+			auto& run = runs[index];
+			Input part(bytes + run.begin, run.end - run.begin);
+			Decoder decoder(part);
+			if(is_map) {
+				run.entries.reserve(run.count);
+				for(size_t i = 0; i < run.count; ++i) {
+					auto key = decoder.next();
+					if(key->object_type() != ObjectType::String) {
+						throw_exception(DecodeException("invalid map key type"));
+					}
+					run.entries.emplace_back(key->as_string(), decoder.next());
+				}
+			} else {
+				auto& array_value = result->as<ObjectType::Array>();
+				for(size_t i = 0; i < run.count; ++i) {
+					array_value[run.first + i] = decoder.next();
+				}
+			}
+		});
+		
+		if(is_map) {
+			auto& map_value = result->as<ObjectType::Map>();
+			for(auto& run: runs) {
+				for(auto& entry: run.entries) {
+					map_value[std::move(entry.first)] = std::move(entry.second);
+				}
+			}
+		}
+		return result;
+	}
+}
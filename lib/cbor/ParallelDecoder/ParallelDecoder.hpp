@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Object/Object.hpp"
+
+namespace cbor {
+	/// Decodes the same tree as Decoder::run from a buffer holding one document.
+	/// A sequential pass over the top-level array or map finds the offsets of about
+	/// thread_count * tasks_per_thread element runs, worker threads then decode the runs concurrently.
+	/// With thread_count == 0 the hardware concurrency is used.
+	auto decode_parallel(const void* data, size_t size, size_t thread_count = 0, size_t tasks_per_thread = 4) -> PObject;
+}
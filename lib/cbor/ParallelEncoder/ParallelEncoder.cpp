@@ -0,0 +1,171 @@
+#include "ParallelEncoder.hpp"
+#include "../OutputDynamic/OutputDynamic.hpp"
+#include "../Encoder/Encoder.hpp"
+#include "../TaskPool/TaskPool.hpp"
+
+#include <deque>
+
+namespace cbor {
+	/// Map entries in the order they are written.
+	using EntryOrder = std::vector<MapValue::value_type const*>;
+	
+	/// Bytes written before the work, then a node or a run of array items or map entries.
+	struct EncodeTask {
+		OutputDynamic output;
+		PObject node;
+		const ArrayValue* array = nullptr;
+		ArrayValue::const_iterator array_begin;
+		MapValue::value_type const* const* entries = nullptr;
+		size_t count = 0;
+		
+		auto has_work() const -> bool {
+			return node || array != nullptr || entries != nullptr;
+		}
+		
+		auto run(EncodeOptions const& options) -> void {
+			Encoder encoder(output);
+			encoder.set_options(options);
+			if(node) {
+				encoder.write_object(node);
+			} else if(array != nullptr) {
+				auto it = array_begin;
+				for(size_t i = 0; i < count; ++i, ++it) {
+					encoder.write_object(*it);
+				}
+			} else if(entries != nullptr) {
+				for(size_t i = 0; i < count; ++i) {
+					auto const& key = entries[i]->first;
+					encoder.write_string(key.data(), (uint32_t)key.size());
+					encoder.write_object(entries[i]->second);
+				}
+			}
+		}
+	};
+	
+	class EncodePlan {
+	public:
+		EncodePlan(EncodeOptions const& options) :
+			_options(options) {
+		}
+		
+		auto plan(PObject const& value, size_t budget) -> void {
+			if(!value) {
+				return;
+			}
+			if(budget > 1 && value->is_array() && value->as_array().size() > 1) {
+				auto const& array_value = value->as_array();
+				encoder(prefix()).write_array(array_value.size());
+				if(array_value.size() >= budget) {
+					split(array_value.size(), budget, [&](size_t begin, size_t count) {
+						auto& task = work();
+						task.array = &array_value;
+						task.array_begin = array_value.begin() + begin;
+						task.count = count;
+					});
+				} else {
+					for(auto const& item: array_value) {
+						plan(item, budget / array_value.size());
+					}
+				}
+			} else if(budget > 1 && value->is_map() && value->as_map().size() > 1) {
+				auto const& map_value = value->as_map();
+				encoder(prefix()).write_map(map_value.size());
+				auto const& entries = order(map_value);
+				if(map_value.size() >= budget) {
+					split(map_value.size(), budget, [&](size_t begin, size_t count) {
+						auto& task = work();
+						task.entries = entries.data() + begin;
+						task.count = count;
+					});
+				} else {
+					for(auto entry: entries) {
+						encoder(prefix()).write_string(entry->first.data(), (uint32_t)entry->first.size());
+						plan(entry->second, budget / map_value.size());
+					}
+				}
+			} else {
+				work().node = value;
+			}
+		}
+		
+		auto tasks() -> std::vector<std::unique_ptr<EncodeTask> >& {
+			return _tasks;
+		}
+	
+	private:
+		template<typename Add_>
+		static auto split(size_t size, size_t parts, Add_ add) -> void {
+			size_t begin = 0;
+			for(size_t part = 0; part < parts; ++part) {
+				auto end = size * (part + 1) / parts;
+				add(begin, end - begin);
+				begin = end;
+			}
+		}
+		
+		/// Task that may still receive head bytes, heads written after some work start a new task.
+		auto prefix() -> OutputDynamic& {
+			if(_tasks.empty() || _tasks.back()->has_work()) {
+				_tasks.push_back(std::make_unique<EncodeTask>());
+			}
+			return _tasks.back()->output;
+		}
+		
+		auto work() -> EncodeTask& {
+			prefix();
+			return *_tasks.back();
+		}
+		
+		auto encoder(Output& output) const -> Encoder {
+			Encoder result(output);
+			result.set_options(_options);
+			return result;
+		}
+		
+		/// Entries of a planned map in written order, a deque keeps them in place until the tasks have run.
+		auto order(MapValue const& map_value) -> EntryOrder const& {
+			auto& entries = _orders.emplace_back();
+			if(_options.deterministic) {
+				_key_order.append(map_value, entries);
+			} else {
+				for(auto const& entry: map_value) {
+					entries.push_back(&entry);
+				}
+			}
+			return entries;
+		}
+		
+		EncodeOptions _options;
+		std::vector<std::unique_ptr<EncodeTask> > _tasks;
+		std::deque<EntryOrder> _orders;
+		DeterministicOrder _key_order;
+	};
+	
+	auto encode_parallel(Output& output, PObject const& value, size_t thread_count, size_t tasks_per_thread) -> void {
+		encode_parallel(output, value, EncodeOptions(), thread_count, tasks_per_thread);
+	}
+	
+	auto encode_parallel(Output& output, PObject const& value, EncodeOptions const& options, size_t thread_count, size_t tasks_per_thread) -> void {
+		if(thread_count == 0) {
+			thread_count = default_thread_count();
+		}
+		if(thread_count == 1) {
+			Encoder encoder(output);
+			encoder.set_options(options);
+			encoder.write_object(value);
+			return;
+		}
+		
+		EncodePlan plan(options);
+		plan.plan(value, thread_count * std::max<size_t>(tasks_per_thread, 1));
+		auto& tasks = plan.tasks();
+		
+		run_tasks(tasks.size(), thread_count, [&](size_t index) {
+			tasks[index]->run(options);
+		});
+		
+		for(auto& task: tasks) {
+			output.put_bytes(task->output.data(), task->output.size());
+		}
+	}
+}
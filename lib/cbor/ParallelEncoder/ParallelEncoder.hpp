@@ -0,0 +1,15 @@
+#pragma once
+
+#include "../Output/Output.hpp"
+#include "../Object/Object.hpp"
+#include "../Encoder/Encoder.hpp"
+
+namespace cbor {
+	/// Writes the same bytes as Encoder::write_object, large arrays and maps are split into
+	/// about thread_count * tasks_per_thread tasks encoded on worker threads and stitched in order.
+	/// With thread_count == 0 the hardware concurrency is used.
+	auto encode_parallel(Output& output, PObject const& value, size_t thread_count = 0, size_t tasks_per_thread = 4) -> void;
+	
+	/// Writes the same bytes as Encoder::write_object on an encoder with options, every task uses them.
+	auto encode_parallel(Output& output, PObject const& value, EncodeOptions const& options, size_t thread_count = 0, size_t tasks_per_thread = 4) -> void;
+}
@@ -0,0 +1,120 @@
+#include "Reader.hpp"
+#include "../Exceptions/Exceptions.hpp"
+
+#include <limits.h>
+#include <math.h>
+#include <algorithm>
+
+namespace cbor {
+	Reader::Reader(Input& in) :
+		_in(&in) {
+	}
+	
+	auto Reader::input() -> Input& {
+		return *_in;
+	}
+	
+	auto Reader::require(uint64_t count) -> void {
+		if(count > INT_MAX || !_in->has_bytes((int)count)) {
+			throw_exception(DecodeException("unexpected end of input"));
+		}
+	}
+	
+	auto Reader::read_head() -> Head {
+		require(1);
+		uint8_t type = _in->get_int8();
+		Head head{(uint8_t)(type >> 5), (uint8_t)(type & 0b00011111), 0};
+		switch(head.minor_type) {
+			case 24:
+				require(1);
+				head.value = _in->get_int8();
+				break;
+			case 25:
+				require(2);
+				head.value = _in->get_int16();
+				break;
+			case 26:
+				require(4);
+				head.value = _in->get_int32();
+				break;
+			case 27:
+				require(8);
+				head.value = _in->get_int64();
+				break;
+			default:
+				if(head.minor_type >= 28) {
+					throw_exception(DecodeException("invalid additional info"));
+				}
+				head.value = head.minor_type;
+				break;
+		}
+		return head;
+	}
+	
+	auto Reader::read_string(Head const& head, std::string& to) -> void {
+		require(head.value);
+		to.resize(head.value);
+		_in->get_bytes(to.data(), (int)head.value);
+	}
+	
+	auto Reader::read_bytes(Head const& head, void* to) -> void {
+		require(head.value);
+		_in->get_bytes(to, (int)head.value);
+	}
+	
+	auto Reader::skip() -> void {
+		skip(read_head());
+	}
+	
+	auto Reader::skip(Head const& head) -> void {
+		// a counter of pending items instead of recursion, deeply nested unknown fields cannot exhaust the stack
+		uint64_t pending = 0;
+		auto current = head;
+		while(true) {
+			uint64_t items = 0;
+			switch(current.major_type) {
+				case 2: // bytes
+				case 3: // string
+					require(current.value);
+					_in->skip((int)current.value);
+					break;
+				case 4: // array
+					items = current.value;
+					break;
+				case 5: // map
+					items = current.value > UINT64_MAX / 2 ? UINT64_MAX : current.value * 2;
+					break;
+				case 6: // tag
+					items = 1;
+					break;
+				default:
+					break;
+			}
+			// saturates, such counts cannot be backed by input and end with unexpected end of input
+			pending = items > UINT64_MAX - pending ? UINT64_MAX : pending + items;
+			if(pending == 0) {
+				return;
+			}
+			--pending;
+			current = read_head();
+		}
+	}
+	
+	auto Reader::reserve_limit(uint64_t count) -> size_t {
+		return (size_t)std::min<uint64_t>(count, (uint64_t)_in->buffered());
+	}
+	
+	auto half_to_double(uint16_t half) -> double {
+		auto exponent = (half >> 10) & 0x1f;
+		auto mantissa = half & 0x3ff;
+		double value;
+		if(exponent == 0) {
+			value = ldexp(mantissa, -24);
+		} else if(exponent != 31) {
+			value = ldexp(mantissa + 1024, exponent - 25);
+		} else {
+			value = mantissa == 0 ? INFINITY : NAN;
+		}
+		return (half & 0x8000) != 0 ? -value : value;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../Input/Input.hpp"
+#include <string>
+#include <cstdint>
+
+namespace cbor {
+	struct Head {
+		uint8_t major_type;
+		uint8_t minor_type;
+		uint64_t value;
+		
+		inline auto is_null() const -> bool {
+			return major_type == 7 && minor_type == 22;
+		}
+		
+		inline auto is_undefined() const -> bool {
+			return major_type == 7 && minor_type == 23;
+		}
+		
+		inline auto is_bool() const -> bool {
+			return major_type == 7 && (minor_type == 20 || minor_type == 21);
+		}
+	};
+	
+	/// Pull reader over an Input, reads one item head at a time without building Object trees.
+	class Reader {
+	public:
+		Reader(Input& in);
+		
+		auto input() -> Input&;
+		
+		auto read_head() -> Head;
+		
+		auto read_string(Head const& head, std::string& to) -> void;
+		
+		auto read_bytes(Head const& head, void* to) -> void;
+		
+		auto skip() -> void;
+		
+		auto skip(Head const& head) -> void;
+		
+		/// Throws DecodeException unless count more bytes can be read, call before allocating for a declared length.
+		auto require(uint64_t count) -> void;
+		
+		/// Upper bound for reserving count items, every item takes at least one of the buffered bytes.
+		auto reserve_limit(uint64_t count) -> size_t;
+	
+	private:
+		Input* _in;
+	};
+	
+	/// Value of an IEEE 754 half precision float.
+	auto half_to_double(uint16_t half) -> double;
+}
@@ -0,0 +1,219 @@
+#include "ResumableEncoder.hpp"
+#include "../Encoder/Encoder.hpp"
+
+#include <string.h>
+#include <algorithm>
+
+namespace cbor {
+	auto ResumableEncoder::Pending::data() const -> unsigned char* {
+		return (unsigned char*)_head;
+	}
+	
+	auto ResumableEncoder::Pending::size() const -> size_t {
+		return _head_size + _payload_size;
+	}
+	
+	auto ResumableEncoder::Pending::put_byte(unsigned char value) -> void {
+		if(_head_size == sizeof(_head)) {
+			throw_exception(EncodeException("item head too large"));
+		}
+		_head[_head_size++] = value;
+	}
+	
+	auto ResumableEncoder::Pending::put_bytes(const unsigned char* data, size_t size) -> void {
+		put_reference(data, size);
+	}
+	
+	auto ResumableEncoder::Pending::put_reference(const unsigned char* data, size_t size) -> void {
+		if(_payload_size != 0) {
+			throw_exception(EncodeException("item has several payloads"));
+		}
+		_payload = data;
+		_payload_size = size;
+	}
+	
+	auto ResumableEncoder::Pending::clear() -> void {
+		_head_size = 0;
+		_head_offset = 0;
+		_payload = nullptr;
+		_payload_size = 0;
+		_payload_offset = 0;
+	}
+	
+	auto ResumableEncoder::Pending::write_to(Output& output, size_t budget) -> size_t {
+		size_t written = 0;
+		if(_head_offset < _head_size) {
+			auto count = std::min(budget, _head_size - _head_offset);
+			output.put_bytes(_head + _head_offset, count);
+			_head_offset += count;
+			written += count;
+		}
+		if(_head_offset == _head_size && _payload_offset < _payload_size) {
+			auto count = std::min(budget - written, _payload_size - _payload_offset);
+			output.put_bytes(_payload + _payload_offset, count);
+			_payload_offset += count;
+			written += count;
+		}
+		return written;
+	}
+	
+	auto ResumableEncoder::Pending::is_empty() const -> bool {
+		return _head_offset == _head_size && _payload_offset == _payload_size;
+	}
+	
+	ResumableEncoder::ResumableEncoder(PObject root, bool deterministic) :
+		_root(std::move(root)), _started(false), _finished(false), _deterministic(deterministic) {
+	}
+	
+	auto ResumableEncoder::start(PObject const& value) -> bool {
+		if(!value) {
+			return false;
+		}
+		_pending.clear();
+		Encoder encoder(_pending);
+		switch(value->object_type()) {
+			case ObjectType::Array: {
+				auto const& array_value = value->as_array();
+				encoder.write_array(array_value.size());
+				if(!array_value.empty()) {
+					_stack.push_back({value.get(), 0, {}, false, 0});
+				}
+				break;
+			}
+			case ObjectType::Map: {
+				auto const& map_value = value->as_map();
+				encoder.write_map(map_value.size());
+				if(!map_value.empty()) {
+					auto order = _order.size();
+					if(_deterministic) {
+						_key_order.append(map_value, _order);
+					}
+					_stack.push_back({value.get(), 0, map_value.begin(), false, order});
+				}
+				break;
+			}
+			case ObjectType::String: {
+				auto const& string_value = value->as_string();
+				encoder.write_string_ref(string_value.data(), string_value.size());
+				break;
+			}
+			case ObjectType::Bytes: {
+				auto const& bytes_value = value->as_bytes();
+				encoder.write_bytes_ref((const uint8_t*)bytes_value.data(), bytes_value.size());
+				break;
+			}
+			case ObjectType::Null:
+				encoder.write_null();
+				break;
+			case ObjectType::Undefined:
+				encoder.write_undefined();
+				break;
+			case ObjectType::Bool:
+				encoder.write_bool(value->as_bool());
+				break;
+			case ObjectType::Int:
+				encoder.write_int(value->as_int());
+				break;
+			case ObjectType::ExtraInt:
+				encoder.write_int(value->as<ObjectType::ExtraInt>().second);
+				break;
+			case ObjectType::Tag:
+			case ObjectType::ExtraTag:
+				encoder.write_tag(value->tag_number());
+				if(value->tagged_item()) {
+					_stack.push_back({value.get(), 0, {}, false, 0});
+				}
+				break;
+			case ObjectType::Special:
+				encoder.write_special(value->as_special());
+				break;
+			case ObjectType::ExtraSpecial:
+				encoder.write_special(value->as<ObjectType::ExtraSpecial>());
+				break;
+			case ObjectType::Native: {
+				// written whole into a buffer of its own, the pending item only refers to it
+				_native.reset();
+				Encoder native_encoder(_native);
+				value->as_native()->encode(native_encoder);
+				_pending.put_reference(_native.data(), _native.size());
+				break;
+			}
+			case ObjectType::Blob:
+				throw_exception(EncodeException("blob payload was streamed to a handler"));
+			case ObjectType::Error:
+				throw_exception(EncodeException("invalid cbor object type"));
+		}
+		return true;
+	}
+	
+	auto ResumableEncoder::advance() -> bool {
+		if(!_started) {
+			_started = true;
+			if(start(_root)) {
+				return true;
+			}
+		}
+		while(!_stack.empty()) {
+			auto& frame = _stack.back();
+			if(frame.object->is_array()) {
+				auto const& array_value = frame.object->as_array();
+				if(frame.index == array_value.size()) {
+					_stack.pop_back();
+				} else if(start(array_value[frame.index++])) {
+					return true;
+				}
+			} else if(frame.object->is_tagged()) {
+				// the frame is gone before the item starts, start may push a frame of its own
+				auto const& item = frame.object->tagged_item();
+				_stack.pop_back();
+				if(start(item)) {
+					return true;
+				}
+			} else {
+				auto const& map_value = frame.object->as_map();
+				if(frame.index == map_value.size()) {
+					if(_deterministic) {
+						_order.resize(frame.order);
+					}
+					_stack.pop_back();
+					continue;
+				}
+				auto const& entry = _deterministic ? *_order[frame.order + frame.index] : *frame.it;
+				if(!frame.in_value) {
+					frame.in_value = true;
+					_pending.clear();
+					Encoder(_pending).write_string_ref(entry.first.data(), entry.first.size());
+					return true;
+				}
+				frame.in_value = false;
+				++frame.index;
+				if(!_deterministic) {
+					++frame.it;
+				}
+				if(start(entry.second)) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+	
+	auto ResumableEncoder::encode_some(Output& output, size_t budget) -> size_t {
+		size_t written = 0;
+		while(written < budget && !_finished) {
+			if(_pending.is_empty() && !advance()) {
+				_finished = true;
+				break;
+			}
+			written += _pending.write_to(output, budget - written);
+		}
+		if(!_finished && _pending.is_empty() && !advance()) {
+			_finished = true;
+		}
+		return written;
+	}
+	
+	auto ResumableEncoder::done() const -> bool {
+		return _finished;
+	}
+}
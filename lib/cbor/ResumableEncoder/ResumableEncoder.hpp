@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../Output/Output.hpp"
+#include "../Object/Object.hpp"
+#include "../Encoder/Encoder.hpp"
+#include "../OutputDynamic/OutputDynamic.hpp"
+
+namespace cbor {
+	/// Encodes an Object tree with an explicit stack instead of recursion and can stop after any byte,
+	/// so a large tree can be streamed through a small Output in fixed-size pieces.
+	/// The tree must not change until done() returns true.
+	class ResumableEncoder {
+	public:
+		/// With deterministic, map entries are written in the order of their encoded keys as RFC 8949 requires.
+		ResumableEncoder(PObject root, bool deterministic = false);
+		
+		/// Writes at most budget bytes to output, returns the number of bytes written.
+		auto encode_some(Output& output, size_t budget) -> size_t;
+		
+		auto done() const -> bool;
+	
+	private:
+		/// Holds the head of the current item and a reference to its payload.
+		class Pending : public Output {
+		public:
+			auto data() const -> unsigned char* override;
+			
+			auto size() const -> size_t override;
+			
+			auto put_byte(unsigned char value) -> void override;
+			
+			auto put_bytes(const unsigned char* data, size_t size) -> void override;
+			
+			auto put_reference(const unsigned char* data, size_t size) -> void override;
+			
+			auto clear() -> void;
+			
+			auto write_to(Output& output, size_t budget) -> size_t;
+			
+			auto is_empty() const -> bool;
+		
+		private:
+			unsigned char _head[16];
+			size_t _head_size = 0;
+			size_t _head_offset = 0;
+			const unsigned char* _payload = nullptr;
+			size_t _payload_size = 0;
+			size_t _payload_offset = 0;
+		};
+		
+		struct Frame {
+			Object const* object;
+			size_t index;
+			MapValue::const_iterator it;
+			bool in_value;
+			size_t order;
+		};
+		
+		auto start(PObject const& value) -> bool;
+		
+		auto advance() -> bool;
+		
+		PObject _root;
+		bool _started;
+		bool _finished;
+		std::vector<Frame> _stack;
+		Pending _pending;
+		OutputDynamic _native;
+		bool _deterministic;
+		std::vector<MapValue::value_type const*> _order;
+		DeterministicOrder _key_order;
+	};
+}
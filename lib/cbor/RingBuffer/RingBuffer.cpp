@@ -0,0 +1,94 @@
+#include "RingBuffer.hpp"
+#include "../Exceptions/Exceptions.hpp"
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <new>
+
+namespace cbor {
+	auto RingBuffer::data() -> uint8_t* {
+		return (uint8_t*)(this + 1);
+	}
+	
+	auto RingBuffer::required_size(size_t capacity) -> size_t {
+		return sizeof(RingBuffer) + capacity;
+	}
+	
+	/// Reason why capacity cannot be used, nullptr if it can.
+	static auto capacity_error(uint64_t capacity) -> const char* {
+		if(capacity == 0 || (capacity & (capacity - 1)) != 0) {
+			return "ring buffer capacity has to be a power of two";
+		}
+		if(capacity > INT_MAX / 2) {
+			return "ring buffer capacity is too large";
+		}
+		return nullptr;
+	}
+	
+	auto RingBuffer::create(void* memory, size_t capacity) -> RingBuffer* {
+		if(auto error = capacity_error(capacity)) {
+			throw_exception(Exception(error));
+		}
+		auto ring = new(memory) RingBuffer;
+		ring->head.store(0, std::memory_order_relaxed);
+		ring->tail.store(0, std::memory_order_relaxed);
+		ring->capacity = capacity;
+		return ring;
+	}
+	
+	static auto map_shared(int fd, size_t size) -> RingBuffer* {
+		auto mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+		if(mapping == MAP_FAILED) {
+			throw_exception(Exception(std::string("mmap failed: ") + strerror(errno)));
+		}
+		return (RingBuffer*)mapping;
+	}
+	
+	auto RingBuffer::create_shared(std::string const& name, size_t capacity) -> RingBuffer* {
+		if(auto error = capacity_error(capacity)) {
+			throw_exception(Exception(error));
+		}
+		auto fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+		if(fd < 0) {
+			throw_exception(Exception(std::string("shm_open failed: ") + strerror(errno)));
+		}
+		if(::ftruncate(fd, (off_t)required_size(capacity)) != 0) {
+			::close(fd);
+			throw_exception(Exception(std::string("ftruncate failed: ") + strerror(errno)));
+		}
+		return create(map_shared(fd, required_size(capacity)), capacity);
+	}
+	
+	auto RingBuffer::open_shared(std::string const& name) -> RingBuffer* {
+		auto fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+		if(fd < 0) {
+			throw_exception(Exception(std::string("shm_open failed: ") + strerror(errno)));
+		}
+		uint64_t capacity = 0;
+		if(::pread(fd, &capacity, sizeof(capacity), offsetof(RingBuffer, capacity)) != sizeof(capacity)) {
+			::close(fd);
+			throw_exception(Exception("shared ring buffer is not initialized"));
+		}
+		// the creator may not have finished initializing, or the segment is corrupted
+		struct stat info;
+		if(capacity_error(capacity) != nullptr || ::fstat(fd, &info) != 0 || (uint64_t)info.st_size < required_size(capacity)) {
+			::close(fd);
+			throw_exception(Exception("shared ring buffer is not initialized"));
+		}
+		return map_shared(fd, required_size(capacity));
+	}
+	
+	auto RingBuffer::unmap_shared(RingBuffer* ring) -> void {
+		::munmap(ring, required_size(ring->capacity));
+	}
+	
+	auto RingBuffer::remove_shared(std::string const& name) -> void {
+		::shm_unlink(name.c_str());
+	}
+}
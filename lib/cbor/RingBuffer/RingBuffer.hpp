@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace cbor {
+	/// Single-producer single-consumer byte ring, laid out so it can live in POSIX shared memory.
+	/// The data bytes follow the header, head and tail are absolute positions on separate cache lines.
+	struct RingBuffer {
+		static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring buffer positions have to be lock-free");
+		
+		alignas(64) std::atomic<uint64_t> head;
+		alignas(64) std::atomic<uint64_t> tail;
+		alignas(64) uint64_t capacity;
+		
+		auto data() -> uint8_t*;
+		
+		/// Bytes of memory a ring with capacity data bytes occupies.
+		static auto required_size(size_t capacity) -> size_t;
+		
+		/// Constructs a ring in memory aligned to 64 bytes, capacity has to be a power of two.
+		static auto create(void* memory, size_t capacity) -> RingBuffer*;
+		
+		static auto create_shared(std::string const& name, size_t capacity) -> RingBuffer*;
+		
+		static auto open_shared(std::string const& name) -> RingBuffer*;
+		
+		static auto unmap_shared(RingBuffer* ring) -> void;
+		
+		static auto remove_shared(std::string const& name) -> void;
+	};
+}
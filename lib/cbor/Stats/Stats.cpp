@@ -0,0 +1,48 @@
+#include "Stats.hpp"
+
+#include <chrono>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace cbor {
+	static constexpr size_t max_stats_slots = 256;
+	
+	static StatsSlot stats_slots[max_stats_slots];
+	
+	static std::atomic<size_t> used_stats_slots{0};
+	
+	auto StatsRecorder::cycles() -> uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+	}
+	
+	auto StatsRecorder::acquire() -> LocalSlot {
+		auto index = used_stats_slots.fetch_add(1, std::memory_order_relaxed);
+		if(index >= max_stats_slots - 1) {
+			return {&stats_slots[max_stats_slots - 1], true};
+		}
+		return {&stats_slots[index], false};
+	}
+	
+	auto decoder_stats() -> DecoderStats {
+		DecoderStats result;
+		auto used = std::min(used_stats_slots.load(std::memory_order_relaxed), max_stats_slots);
+		for(size_t i = 0; i < used; ++i) {
+			auto const& slot = stats_slots[i];
+			for(size_t state = 0; state < decoder_state_count; ++state) {
+				result.state_steps[state] += slot.state_steps[state].load(std::memory_order_relaxed);
+				result.state_cycles[state] += slot.state_cycles[state].load(std::memory_order_relaxed);
+			}
+			result.bytes_copied += slot.bytes_copied.load(std::memory_order_relaxed);
+			result.allocations += slot.allocations.load(std::memory_order_relaxed);
+			result.max_depth = std::max(result.max_depth, slot.max_depth.load(std::memory_order_relaxed));
+		}
+		return result;
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#ifndef CBOR_STATS
+#define CBOR_STATS 0
+#endif
+
+/// Keeps its arguments only in builds with CBOR_STATS, instrumentation compiles to nothing otherwise.
+#if CBOR_STATS
+#define CBOR_STATS_ONLY(...) __VA_ARGS__
+#else
+#define CBOR_STATS_ONLY(...)
+#endif
+
+namespace cbor {
+	constexpr size_t decoder_state_count = 21;
+	
+	struct DecoderStats {
+		uint64_t state_steps[decoder_state_count] = {};
+		uint64_t state_cycles[decoder_state_count] = {};
+		uint64_t bytes_copied = 0;
+		uint64_t allocations = 0;
+		uint64_t max_depth = 0;
+	};
+	
+	/// Sums the counters of all threads with relaxed loads and no locks, all zero without CBOR_STATS.
+	/// Counters only grow, take the difference of two snapshots for rates.
+	auto decoder_stats() -> DecoderStats;
+	
+	/// Counters written by a single thread, the last slot is shared by threads beyond the slot limit.
+	struct StatsSlot {
+		std::atomic<uint64_t> state_steps[decoder_state_count];
+		std::atomic<uint64_t> state_cycles[decoder_state_count];
+		std::atomic<uint64_t> bytes_copied;
+		std::atomic<uint64_t> allocations;
+		std::atomic<uint64_t> max_depth;
+	};
+	
+	class StatsRecorder {
+	public:
+		static auto cycles() -> uint64_t;
+		
+		static inline auto add_step(size_t state, uint64_t cycles) -> void {
+			auto& local = slot();
+			add(local, local.slot->state_steps[state], 1);
+			add(local, local.slot->state_cycles[state], cycles);
+		}
+		
+		static inline auto add_bytes_copied(uint64_t count) -> void {
+			auto& local = slot();
+			add(local, local.slot->bytes_copied, count);
+		}
+		
+		static inline auto add_allocations(uint64_t count) -> void {
+			auto& local = slot();
+			add(local, local.slot->allocations, count);
+		}
+		
+		static inline auto record_depth(uint64_t depth) -> void {
+			auto& max_depth = slot().slot->max_depth;
+			auto current = max_depth.load(std::memory_order_relaxed);
+			while(depth > current && !max_depth.compare_exchange_weak(current, depth, std::memory_order_relaxed)) {
+			}
+		}
+	
+	private:
+		struct LocalSlot {
+			StatsSlot* slot;
+			bool shared;
+		};
+		
+		static auto acquire() -> LocalSlot;
+		
+		static inline auto slot() -> LocalSlot& {
+			thread_local LocalSlot local = acquire();
+			return local;
+		}
+		
+		static inline auto add(LocalSlot const& local, std::atomic<uint64_t>& counter, uint64_t value) -> void {
+			if(local.shared) {
+				counter.fetch_add(value, std::memory_order_relaxed);
+			} else {
+				// single writer, a plain load and store is enough
+				counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+			}
+		}
+	};
+	
+	/// Adds the cycles spent until the end of the scope to the counters of a decoder state.
+	class StateTimer {
+	public:
+		StateTimer(size_t state) :
+			_state(state), _begin(StatsRecorder::cycles()) {
+		}
+		
+		~StateTimer() {
+			StatsRecorder::add_step(_state, StatsRecorder::cycles() - _begin);
+		}
+	
+	private:
+		size_t _state;
+		uint64_t _begin;
+	};
+}
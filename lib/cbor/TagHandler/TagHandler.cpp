@@ -0,0 +1,144 @@
+#include "TagHandler.hpp"
+#include "../Codec/Codec.hpp"
+
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+namespace cbor {
+	static auto float_value(Head const& head) -> double {
+		if(head.minor_type == 25) {
+			return half_to_double((uint16_t)head.value);
+		}
+		if(head.minor_type == 26) {
+			auto bits = (uint32_t)head.value;
+			float single;
+			memcpy(&single, &bits, sizeof(single));
+			return single;
+		}
+		double result;
+		memcpy(&result, &head.value, sizeof(result));
+		return result;
+	}
+	
+	auto TagHandler<TimePoint>::decode(Reader& reader, uint64_t, TimePoint& value) -> void {
+		using Duration = TimePoint::duration;
+		auto head = reader.read_head();
+		constexpr auto max_seconds = std::chrono::duration_cast<std::chrono::seconds>(Duration::max()).count();
+		if(head.major_type == 7 && head.minor_type >= 25 && head.minor_type <= 27) {
+			auto seconds = float_value(head);
+			if(!isfinite(seconds) || fabs(seconds) >= (double)max_seconds) {
+				throw_exception(DecodeException("epoch time out of range"));
+			}
+			// whole seconds are converted separately, nanosecond counts since the epoch do not fit into a double
+			auto whole = floor(seconds);
+			auto fraction = std::chrono::round<Duration>(std::chrono::duration<double>(seconds - whole));
+			value = TimePoint(std::chrono::duration_cast<Duration>(std::chrono::seconds((int64_t)whole)) + fraction);
+			return;
+		}
+		int64_t seconds;
+		Codec<int64_t>::decode(reader, head, seconds);
+		if(seconds > max_seconds || seconds < -max_seconds) {
+			throw_exception(DecodeException("epoch time out of range"));
+		}
+		value = TimePoint(std::chrono::duration_cast<Duration>(std::chrono::seconds(seconds)));
+	}
+	
+	auto TagHandler<TimePoint>::encode(Encoder& encoder, TimePoint const& value) -> void {
+		auto whole = std::chrono::floor<std::chrono::seconds>(value.time_since_epoch());
+		auto fraction = value.time_since_epoch() - whole;
+		encoder.write_tag(1);
+		if(fraction == TimePoint::duration::zero()) {
+			encoder.write_int((int64_t)whole.count());
+		} else {
+			encoder.write_double((double)whole.count() + std::chrono::duration<double>(fraction).count());
+		}
+	}
+
+#ifdef __SIZEOF_INT128__
+	auto TagHandler<__int128>::decode(Reader& reader, uint64_t tag, __int128& value) -> void {
+		auto head = reader.read_head();
+		if(head.major_type != 2) {
+			throw_exception(DecodeException("expected bignum bytes"));
+		}
+		uint8_t small[16];
+		std::vector<uint8_t> large;
+		auto bytes = small;
+		if(head.value > sizeof(small)) {
+			// the length comes from the input, so it is checked before allocating
+			reader.require(head.value);
+			large.resize(head.value);
+			bytes = large.data();
+		}
+		reader.read_bytes(head, bytes);
+		// leading zero bytes are allowed and do not count towards the magnitude
+		size_t skip = 0;
+		while(skip < head.value && bytes[skip] == 0) {
+			++skip;
+		}
+		if(head.value - skip > 16) {
+			throw_exception(DecodeException("bignum out of range"));
+		}
+		unsigned __int128 magnitude = 0;
+		for(auto i = skip; i < head.value; ++i) {
+			magnitude = (magnitude << 8) | bytes[i];
+		}
+		if(magnitude >> 127 != 0) {
+			throw_exception(DecodeException("bignum out of range"));
+		}
+		value = tag == 2 ? (__int128)magnitude : -1 - (__int128)magnitude;
+	}
+	
+	auto TagHandler<__int128>::encode(Encoder& encoder, __int128 const& value) -> void {
+		auto magnitude = value < 0 ? ~(unsigned __int128)value : (unsigned __int128)value;
+		uint8_t bytes[16];
+		for(size_t i = 0; i < 16; ++i) {
+			bytes[15 - i] = (uint8_t)(magnitude >> (i * 8));
+		}
+		size_t skip = 0;
+		while(skip < 16 && bytes[skip] == 0) {
+			++skip;
+		}
+		encoder.write_tag(value < 0 ? 3 : 2);
+		encoder.write_bytes(bytes + skip, (uint32_t)(16 - skip));
+	}
+#endif
+	
+	auto TagHandler<DecimalFraction>::decode(Reader& reader, uint64_t, DecimalFraction& value) -> void {
+		auto head = reader.read_head();
+		if(head.major_type != 4 || head.value != 2) {
+			throw_exception(DecodeException("expected decimal fraction array"));
+		}
+		Codec<int64_t>::decode(reader, reader.read_head(), value.exponent);
+		Codec<int64_t>::decode(reader, reader.read_head(), value.mantissa);
+	}
+	
+	auto TagHandler<DecimalFraction>::encode(Encoder& encoder, DecimalFraction const& value) -> void {
+		encoder.write_tag(4);
+		encoder.write_array(2);
+		encoder.write_int(value.exponent);
+		encoder.write_int(value.mantissa);
+	}
+	
+	auto TagHandler<Uuid>::decode(Reader& reader, uint64_t, Uuid& value) -> void {
+		auto head = reader.read_head();
+		if(head.major_type != 2 || head.value != value.bytes.size()) {
+			throw_exception(DecodeException("expected 16-byte uuid"));
+		}
+		reader.read_bytes(head, value.bytes.data());
+	}
+	
+	auto TagHandler<Uuid>::encode(Encoder& encoder, Uuid const& value) -> void {
+		encoder.write_tag(37);
+		encoder.write_bytes(value.bytes.data(), (uint32_t)value.bytes.size());
+	}
+	
+	auto TagRegistry::find(uint64_t tag) const -> Decode {
+		for(auto const& handler: _handlers) {
+			if(handler.handles(tag)) {
+				return handler.decode;
+			}
+		}
+		return nullptr;
+	}
+}
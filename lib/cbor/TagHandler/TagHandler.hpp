@@ -0,0 +1,152 @@
+#pragma once
+
+#include "../Reader/Reader.hpp"
+#include "../Encoder/Encoder.hpp"
+#include <array>
+#include <chrono>
+#include <type_traits>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace cbor {
+	/// Turns the item following a tag straight into a native T in cbor::decode, specialize to register a handler.
+	///
+	/// template<>
+	/// struct cbor::TagHandler<Money> {
+	/// 	static constexpr auto handles(uint64_t tag) -> bool { return tag == 4; }
+	/// 	static auto decode(Reader& reader, uint64_t tag, Money& value) -> void;
+	/// 	static auto encode(Encoder& encoder, Money const& value) -> void;
+	/// };
+	template<typename T>
+	struct TagHandler;
+	
+	template<typename T, typename = void>
+	struct IsTagHandled : std::false_type {
+	};
+	
+	template<typename T>
+	struct IsTagHandled<T, std::void_t<decltype(TagHandler<T>::handles(0))> > : std::true_type {
+	};
+	
+	template<typename T>
+	constexpr auto is_tag_handled = IsTagHandled<T>::value;
+	
+	using TimePoint = std::chrono::system_clock::time_point;
+	
+	/// UUID in network byte order.
+	struct Uuid {
+		std::array<uint8_t, 16> bytes;
+	};
+	
+	/// mantissa * 10^exponent.
+	struct DecimalFraction {
+		int64_t exponent;
+		int64_t mantissa;
+	};
+	
+	/// Tag 1, integer or floating-point seconds since the epoch, whole seconds are written as integers.
+	template<>
+	struct TagHandler<TimePoint> {
+		static constexpr auto handles(uint64_t tag) -> bool {
+			return tag == 1;
+		}
+		
+		static auto decode(Reader& reader, uint64_t tag, TimePoint& value) -> void;
+		
+		static auto encode(Encoder& encoder, TimePoint const& value) -> void;
+	};
+
+#ifdef __SIZEOF_INT128__
+	/// Tags 2 and 3, bignums whose magnitude fits into 128 bits, always written tagged.
+	template<>
+	struct TagHandler<__int128> {
+		static constexpr auto handles(uint64_t tag) -> bool {
+			return tag == 2 || tag == 3;
+		}
+		
+		static auto decode(Reader& reader, uint64_t tag, __int128& value) -> void;
+		
+		static auto encode(Encoder& encoder, __int128 const& value) -> void;
+	};
+#endif
+	
+	/// Tag 4, an array of exponent and mantissa, bignum mantissas are not supported.
+	template<>
+	struct TagHandler<DecimalFraction> {
+		static constexpr auto handles(uint64_t tag) -> bool {
+			return tag == 4;
+		}
+		
+		static auto decode(Reader& reader, uint64_t tag, DecimalFraction& value) -> void;
+		
+		static auto encode(Encoder& encoder, DecimalFraction const& value) -> void;
+	};
+	
+	/// Tag 37, a 16-byte string.
+	template<>
+	struct TagHandler<Uuid> {
+		static constexpr auto handles(uint64_t tag) -> bool {
+			return tag == 37;
+		}
+		
+		static auto decode(Reader& reader, uint64_t tag, Uuid& value) -> void;
+		
+		static auto encode(Encoder& encoder, Uuid const& value) -> void;
+	};
+	
+	/// Object tree node holding a value that TagHandler<T> decoded, written back with TagHandler<T>::encode.
+	template<typename T>
+	class Native : public NativeObject {
+	public:
+		explicit Native(T value) : value(std::move(value)) {
+		}
+		
+		auto encode(Encoder& encoder) const -> void override {
+			TagHandler<T>::encode(encoder, value);
+		}
+		
+		T value;
+	};
+	
+	/// The value node holds when it is a Native<T>, nullptr otherwise.
+	template<typename T>
+	auto native_value(Object const& node) -> T const* {
+		if(!node.is_native()) {
+			return nullptr;
+		}
+		auto native = dynamic_cast<Native<T> const*>(node.as_native().get());
+		return native != nullptr ? &native->value : nullptr;
+	}
+	
+	/// Tag handlers the Object tree decoder runs, see Decoder::set_tag_registry.
+	/// A handled tag and its item become one Native node, other tags stay Tag nodes.
+	class TagRegistry {
+	public:
+		using Decode = auto (*)(Reader& reader, uint64_t tag) -> NativeValue;
+		
+		/// Decodes the items of the tags TagHandler<T> handles into Native<T>, handlers added first win.
+		template<typename T>
+		auto add() -> void {
+			_handlers.push_back({&TagHandler<T>::handles, &decode_native<T>});
+		}
+		
+		/// Returns nullptr when no handler takes tag.
+		auto find(uint64_t tag) const -> Decode;
+	
+	private:
+		template<typename T>
+		static auto decode_native(Reader& reader, uint64_t tag) -> NativeValue {
+			T value{};
+			TagHandler<T>::decode(reader, tag, value);
+			return std::make_shared<Native<T> const>(std::move(value));
+		}
+		
+		struct Handler {
+			bool (*handles)(uint64_t tag);
+			Decode decode;
+		};
+		
+		std::vector<Handler> _handlers;
+	};
+}
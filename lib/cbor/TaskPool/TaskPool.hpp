@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../Exceptions/Exceptions.hpp"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <exception>
+#include <algorithm>
+
+namespace cbor {
+	/// Thread count used when the caller passes 0.
+	inline auto default_thread_count() -> size_t {
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+	
+	/// Calls run(index) for every index below task_count on up to thread_count threads including the caller,
+	/// the first exception stops handing out tasks and is rethrown after all threads joined.
+	template<typename Run_>
+	auto run_tasks(size_t task_count, size_t thread_count, Run_ run) -> void {
+		std::atomic<size_t> next{0};
+		std::exception_ptr error;
+		std::mutex error_mutex;
+		auto worker = [&] {
+			for(auto index = next++; index < task_count; index = next++) {
+#if CBOR_EXCEPTIONS
+				try {
+					run(index);
+				} catch(...) {
+					std::lock_guard<std::mutex> lock(error_mutex);
+					if(!error) {
+						error = std::current_exception();
+					}
+					next = task_count;
+				}
+#else
+				run(index);
+#endif
+			}
+		};
+		std::vector<std::thread> threads;
+		for(size_t i = 1; i < std::min(thread_count, task_count); ++i) {
+			threads.emplace_back(worker);
+		}
+		worker();
+		for(auto& thread: threads) {
+			thread.join();
+		}
+#if CBOR_EXCEPTIONS
+		if(error) {
+			std::rethrow_exception(error);
+		}
+#endif
+	}
+}
@@ -0,0 +1,282 @@
+#include "Utf8.hpp"
+
+#include <string.h>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define CBOR_UTF8_X86
+#endif
+
+namespace cbor {
+	static auto is_valid_utf8_scalar(const uint8_t* data, size_t size) -> bool {
+		size_t i = 0;
+		while(i < size) {
+			auto lead = data[i];
+			if(lead < 0x80) {
+				++i;
+				continue;
+			}
+			size_t length;
+			uint8_t low = 0x80;
+			uint8_t high = 0xbf;
+			if(lead < 0xc2) {
+				return false;
+			} else if(lead < 0xe0) {
+				length = 2;
+			} else if(lead < 0xf0) {
+				length = 3;
+				low = lead == 0xe0 ? 0xa0 : 0x80;
+				high = lead == 0xed ? 0x9f : 0xbf;
+			} else if(lead < 0xf5) {
+				length = 4;
+				low = lead == 0xf0 ? 0x90 : 0x80;
+				high = lead == 0xf4 ? 0x8f : 0xbf;
+			} else {
+				return false;
+			}
+			if(size - i < length || data[i + 1] < low || data[i + 1] > high) {
+				return false;
+			}
+			for(size_t j = 2; j < length; ++j) {
+				if((data[i + j] & 0xc0) != 0x80) {
+					return false;
+				}
+			}
+			i += length;
+		}
+		return true;
+	}
+
+#ifdef CBOR_UTF8_X86
+	// Lookup algorithm of Keiser and Lemire: every error sets the same bit in three tables indexed
+	// by the high and low nibble of the previous byte and the high nibble of the current one.
+	static constexpr uint8_t too_short = 1 << 0;
+	static constexpr uint8_t too_long = 1 << 1;
+	static constexpr uint8_t overlong_3 = 1 << 2;
+	static constexpr uint8_t too_large = 1 << 3;
+	static constexpr uint8_t surrogate = 1 << 4;
+	static constexpr uint8_t overlong_2 = 1 << 5;
+	static constexpr uint8_t too_large_1000 = 1 << 6;
+	static constexpr uint8_t overlong_4 = 1 << 6;
+	static constexpr uint8_t two_conts = 1 << 7;
+	static constexpr uint8_t carry = too_short | too_long | two_conts;
+	
+	alignas(16) static constexpr uint8_t byte_1_high_table[16] = {
+		too_long, too_long, too_long, too_long,
+		too_long, too_long, too_long, too_long,
+		two_conts, two_conts, two_conts, two_conts,
+		too_short | overlong_2,
+		too_short,
+		too_short | overlong_3 | surrogate,
+		too_short | too_large | too_large_1000 | overlong_4,
+	};
+	
+	alignas(16) static constexpr uint8_t byte_1_low_table[16] = {
+		carry | overlong_3 | overlong_2 | overlong_4,
+		carry | overlong_2,
+		carry,
+		carry,
+		carry | too_large,
+		carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000 | surrogate,
+		carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000,
+	};
+	
+	alignas(16) static constexpr uint8_t byte_2_high_table[16] = {
+		too_short, too_short, too_short, too_short,
+		too_short, too_short, too_short, too_short,
+		too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+		too_long | overlong_2 | two_conts | overlong_3 | too_large,
+		too_long | overlong_2 | two_conts | surrogate | too_large,
+		too_long | overlong_2 | two_conts | surrogate | too_large,
+		too_short, too_short, too_short, too_short,
+	};
+	
+	// a lead byte in the last three positions that needs more bytes than are left
+	alignas(16) static constexpr uint8_t incomplete_table[16] = {
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1,
+	};
+	
+	__attribute__((target("ssse3")))
+	static auto is_valid_utf8_ssse3(const uint8_t* data, size_t size) -> bool {
+		auto byte_1_high = _mm_load_si128((const __m128i*)byte_1_high_table);
+		auto byte_1_low = _mm_load_si128((const __m128i*)byte_1_low_table);
+		auto byte_2_high = _mm_load_si128((const __m128i*)byte_2_high_table);
+		auto incomplete = _mm_load_si128((const __m128i*)incomplete_table);
+		auto nibble = _mm_set1_epi8(0x0f);
+		auto error = _mm_setzero_si128();
+		auto prev = _mm_setzero_si128();
+		auto prev_incomplete = _mm_setzero_si128();
+		alignas(16) uint8_t tail[16];
+		while(size > 0) {
+			__m128i input;
+			if(size >= 16) {
+				input = _mm_loadu_si128((const __m128i*)data);
+				data += 16;
+				size -= 16;
+			} else {
+				// zero padding is ASCII, so a sequence cut by the end is still reported
+				memset(tail, 0, sizeof(tail));
+				memcpy(tail, data, size);
+				input = _mm_load_si128((const __m128i*)tail);
+				size = 0;
+			}
+			if(_mm_movemask_epi8(input) == 0) {
+				error = _mm_or_si128(error, prev_incomplete);
+				prev_incomplete = _mm_setzero_si128();
+			} else {
+				auto prev1 = _mm_alignr_epi8(input, prev, 15);
+				auto special_cases = _mm_and_si128(
+					_mm_and_si128(
+						_mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+						_mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble))
+					),
+					_mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble))
+				);
+				auto prev2 = _mm_alignr_epi8(input, prev, 14);
+				auto prev3 = _mm_alignr_epi8(input, prev, 13);
+				auto must_be_continuation = _mm_and_si128(
+					_mm_or_si128(
+						_mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xe0 - 0x80))),
+						_mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xf0 - 0x80)))
+					),
+					_mm_set1_epi8((char)0x80)
+				);
+				error = _mm_or_si128(error, _mm_xor_si128(must_be_continuation, special_cases));
+				prev_incomplete = _mm_subs_epu8(input, incomplete);
+			}
+			prev = input;
+		}
+		error = _mm_or_si128(error, prev_incomplete);
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xffff;
+	}
+	
+	__attribute__((target("avx2")))
+	static auto is_valid_utf8_avx2(const uint8_t* data, size_t size) -> bool {
+		auto byte_1_high = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)byte_1_high_table));
+		auto byte_1_low = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)byte_1_low_table));
+		auto byte_2_high = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)byte_2_high_table));
+		auto incomplete = _mm256_inserti128_si256(_mm256_set1_epi8((char)0xff), _mm_load_si128((const __m128i*)incomplete_table), 1);
+		auto nibble = _mm256_set1_epi8(0x0f);
+		auto error = _mm256_setzero_si256();
+		auto prev = _mm256_setzero_si256();
+		auto prev_incomplete = _mm256_setzero_si256();
+		alignas(32) uint8_t tail[32];
+		while(size > 0) {
+			__m256i input;
+			if(size >= 32) {
+				input = _mm256_loadu_si256((const __m256i*)data);
+				data += 32;
+				size -= 32;
+			} else {
+				memset(tail, 0, sizeof(tail));
+				memcpy(tail, data, size);
+				input = _mm256_load_si256((const __m256i*)tail);
+				size = 0;
+			}
+			if(_mm256_movemask_epi8(input) == 0) {
+				error = _mm256_or_si256(error, prev_incomplete);
+				prev_incomplete = _mm256_setzero_si256();
+			} else {
+				// the high lane of prev followed by the low lane of input, alignr works within lanes
+				auto shifted = _mm256_permute2x128_si256(prev, input, 0x21);
+				auto prev1 = _mm256_alignr_epi8(input, shifted, 15);
+				auto special_cases = _mm256_and_si256(
+					_mm256_and_si256(
+						_mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+						_mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, nibble))
+					),
+					_mm256_shuffle_epi8(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble))
+				);
+				auto prev2 = _mm256_alignr_epi8(input, shifted, 14);
+				auto prev3 = _mm256_alignr_epi8(input, shifted, 13);
+				auto must_be_continuation = _mm256_and_si256(
+					_mm256_or_si256(
+						_mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xe0 - 0x80))),
+						_mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xf0 - 0x80)))
+					),
+					_mm256_set1_epi8((char)0x80)
+				);
+				error = _mm256_or_si256(error, _mm256_xor_si256(must_be_continuation, special_cases));
+				prev_incomplete = _mm256_subs_epu8(input, incomplete);
+			}
+			prev = input;
+		}
+		error = _mm256_or_si256(error, prev_incomplete);
+		return _mm256_testz_si256(error, error) != 0;
+	}
+	
+	static const bool has_avx2 = __builtin_cpu_supports("avx2");
+	static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+#else
+	static const bool has_avx2 = false;
+	static const bool has_ssse3 = false;
+#endif
+	
+	static auto supports(Utf8Isa isa) -> bool {
+		switch(isa) {
+			case Utf8Isa::Avx2:
+				return has_avx2;
+			case Utf8Isa::Ssse3:
+				return has_ssse3;
+			default:
+				return true;
+		}
+	}
+	
+	static Utf8Isa selected_isa = has_avx2 ? Utf8Isa::Avx2 : has_ssse3 ? Utf8Isa::Ssse3 : Utf8Isa::Scalar;
+	
+	auto utf8_isa() -> Utf8Isa {
+		return selected_isa;
+	}
+	
+	auto set_utf8_isa(Utf8Isa isa) -> bool {
+		if(!supports(isa)) {
+			return false;
+		}
+		selected_isa = isa;
+		return true;
+	}
+	
+	auto is_valid_utf8(const void* data, size_t size) -> bool {
+		auto bytes = (const uint8_t*)data;
+		// typical keys are short ASCII, they never reach the vector code
+		while(size >= 8) {
+			uint64_t word;
+			memcpy(&word, bytes, 8);
+			if((word & 0x8080808080808080ull) != 0) {
+				break;
+			}
+			bytes += 8;
+			size -= 8;
+		}
+		if(size < 8) {
+			while(size > 0 && *bytes < 0x80) {
+				++bytes;
+				--size;
+			}
+			if(size == 0) {
+				return true;
+			}
+		}
+#ifdef CBOR_UTF8_X86
+		if(selected_isa == Utf8Isa::Avx2) {
+			return is_valid_utf8_avx2(bytes, size);
+		}
+		if(selected_isa == Utf8Isa::Ssse3) {
+			return is_valid_utf8_ssse3(bytes, size);
+		}
+#endif
+		return is_valid_utf8_scalar(bytes, size);
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cbor {
+	/// Checks that data is well-formed UTF-8: no overlong forms, surrogates or code points above U+10FFFF.
+	/// ASCII runs are skipped a word at a time, the rest uses AVX2 or SSSE3 when the CPU has them.
+	auto is_valid_utf8(const void* data, size_t size) -> bool;
+	
+	/// Implementations is_valid_utf8 dispatches to after the ASCII prefix.
+	enum class Utf8Isa {
+		Scalar,
+		Ssse3,
+		Avx2,
+	};
+	
+	/// The implementation is_valid_utf8 uses, the best one the CPU has unless overridden.
+	auto utf8_isa() -> Utf8Isa;
+	
+	/// Internal override for testing every implementation, returns false and changes nothing when the CPU or
+	/// build lacks isa. Not synchronized, set it while no other thread validates.
+	auto set_utf8_isa(Utf8Isa isa) -> bool;
+}
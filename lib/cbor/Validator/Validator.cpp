@@ -0,0 +1,110 @@
+#include "Validator.hpp"
+
+#include <limits.h>
+
+namespace cbor {
+	auto Validator::check(const void* data, size_t size) -> Error {
+		return check(data, size, nullptr);
+	}
+	
+	auto Validator::check(const void* data, size_t size, DecodeLimits const& limits) -> Error {
+		DecodeBudget budget(limits);
+		return check(data, size, &budget);
+	}
+	
+	auto Validator::check(const void* data, size_t size, DecodeBudget* budget) -> Error {
+		auto bytes = (const uint8_t*)data;
+		if(size == 0) {
+			return {ErrorCode::Empty, 0};
+		}
+		_stack.clear();
+		size_t offset = 0;
+		bool has_root = false;
+		while(true) {
+			while(!_stack.empty() && _stack.back().remaining == 0) {
+				_stack.pop_back();
+			}
+			if(has_root && _stack.empty()) {
+				if(offset < size) {
+					return {ErrorCode::TrailingData, offset};
+				}
+				return {};
+			}
+			if(offset >= size) {
+				return {ErrorCode::UnexpectedEnd, offset};
+			}
+			
+			auto start = offset;
+			uint8_t major_type = bytes[offset] >> 5;
+			uint8_t minor_type = bytes[offset] & 0b00011111;
+			++offset;
+			uint64_t value = minor_type;
+			if(minor_type >= 28) {
+				return {ErrorCode::InvalidHead, start};
+			}
+			if(minor_type >= 24) {
+				size_t width = (size_t)1 << (minor_type - 24);
+				if(size - offset < width) {
+					return {ErrorCode::UnexpectedEnd, size};
+				}
+				value = 0;
+				for(size_t i = 0; i < width; ++i) {
+					value = (value << 8) | bytes[offset++];
+				}
+			}
+			
+			if(!_stack.empty()) {
+				auto& parent = _stack.back();
+				if(parent.is_map) {
+					if(parent.at_key && major_type != 3) {
+						return {ErrorCode::InvalidMapKey, start};
+					}
+					parent.at_key = !parent.at_key;
+				}
+				--parent.remaining;
+			}
+			has_root = true;
+			if(budget != nullptr && !budget->item()) {
+				return {ErrorCode::LimitExceeded, start};
+			}
+			
+			switch(major_type) {
+				case 2: // bytes
+				case 3: // string
+					if(minor_type == 27 || value > INT_MAX) {
+						return {ErrorCode::TooLong, start};
+					}
+					if(budget != nullptr && !budget->payload(value)) {
+						return {ErrorCode::LimitExceeded, start};
+					}
+					if(size - offset < value) {
+						return {ErrorCode::UnexpectedEnd, size};
+					}
+					offset += value;
+					break;
+				case 4: // array
+				case 5: // map
+					if(minor_type == 27) {
+						return {ErrorCode::TooLong, start};
+					}
+					if(budget != nullptr && (!budget->depth(_stack.size()) || !budget->container(value, major_type == 5))) {
+						return {ErrorCode::LimitExceeded, start};
+					}
+					if(value > 0) {
+						// Decoder counts keys and values as items
+						_stack.push_back({major_type == 5 ? value * 2 : value, major_type == 5, true});
+					}
+					break;
+				case 6: // tag
+					// a prefix that takes the slot of its item, the next item fills it
+					if(budget != nullptr && !budget->depth(_stack.size())) {
+						return {ErrorCode::LimitExceeded, start};
+					}
+					_stack.push_back({1, false, false});
+					break;
+				default:
+					break;
+			}
+		}
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../Error/Error.hpp"
+#include "../DecodeLimits/DecodeLimits.hpp"
+#include <vector>
+
+namespace cbor {
+	/// Checks without throwing or building objects that Decoder::run accepts a buffer,
+	/// keeps its nesting stack between calls so that checking a message does not allocate.
+	class Validator {
+	public:
+		auto check(const void* data, size_t size) -> Error;
+		
+		/// Also charges the document against limits the same way Decoder does after Decoder::set_limits.
+		auto check(const void* data, size_t size, DecodeLimits const& limits) -> Error;
+	
+	private:
+		auto check(const void* data, size_t size, DecodeBudget* budget) -> Error;
+		
+		struct Frame {
+			uint64_t remaining;
+			bool is_map;
+			bool at_key;
+		};
+		
+		std::vector<Frame> _stack;
+	};
+}
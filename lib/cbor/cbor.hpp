@@ -17,9 +17,35 @@
 #pragma once
 
 #include "Input/Input.hpp"
+#include "InputStream/InputStream.hpp"
+#include "InputRing/InputRing.hpp"
 #include "Encoder/Encoder.hpp"
 #include "Decoder/Decoder.hpp"
 #include "OutputStatic/OutputStatic.hpp"
 #include "OutputDynamic/OutputDynamic.hpp"
+#include "OutputSegmented/OutputSegmented.hpp"
+#include "OutputSpan/OutputSpan.hpp"
+#include "OutputCounter/OutputCounter.hpp"
+#include "OutputMapped/OutputMapped.hpp"
+#include "OutputRing/OutputRing.hpp"
+#include "FrameWriter/FrameWriter.hpp"
+#include "FrameSplitter/FrameSplitter.hpp"
+#include "Crc32c/Crc32c.hpp"
+#include "Utf8/Utf8.hpp"
 #include "Exceptions/Exceptions.hpp"
+#include "Error/Error.hpp"
+#include "Validator/Validator.hpp"
+#include "DecodeLimits/DecodeLimits.hpp"
+#include "Allocator/Allocator.hpp"
 #include "Object/Object.hpp"
+#include "ObjectInterner/ObjectInterner.hpp"
+#include "Hash/Hash.hpp"
+#include "Json/Json.hpp"
+#include "ParallelEncoder/ParallelEncoder.hpp"
+#include "ParallelDecoder/ParallelDecoder.hpp"
+#include "ResumableEncoder/ResumableEncoder.hpp"
+#include "EncodeCache/EncodeCache.hpp"
+#include "Reader/Reader.hpp"
+#include "TagHandler/TagHandler.hpp"
+#include "Codec/Codec.hpp"
+#include "MessageTemplate/MessageTemplate.hpp"
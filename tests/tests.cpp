@@ -18,7 +18,102 @@
 
 #include <cbor/cbor.hpp>
 #include <cstring>
+// the checks also run the calls they test, so they stay enabled in release builds
+#undef NDEBUG
 #include <cassert>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+
+struct Address {
+	std::string city;
+	std::optional<int32_t> zip;
+};
+
+struct Person {
+	std::string name;
+	uint8_t age;
+	std::vector<Address> addresses;
+	std::variant<int64_t, std::string> id;
+	std::unordered_map<std::string, bool> flags;
+};
+
+template<>
+struct cbor::Binding<Address> {
+	static constexpr auto fields = std::make_tuple(
+		cbor::field("city", &Address::city),
+		cbor::field("zip", &Address::zip)
+	);
+};
+
+template<>
+struct cbor::Binding<Person> {
+	static constexpr auto fields = std::make_tuple(
+		cbor::field("name", &Person::name),
+		cbor::field("age", &Person::age),
+		cbor::field("addresses", &Person::addresses),
+		cbor::field("id", &Person::id),
+		cbor::field("flags", &Person::flags)
+	);
+};
+
+struct Payment {
+	cbor::TimePoint time;
+	cbor::DecimalFraction amount;
+	cbor::Uuid id;
+	__int128 balance;
+	std::optional<cbor::TimePoint> settled;
+};
+
+template<>
+struct cbor::Binding<Payment> {
+	static constexpr auto fields = std::make_tuple(
+		cbor::field("time", &Payment::time),
+		cbor::field("amount", &Payment::amount),
+		cbor::field("id", &Payment::id),
+		cbor::field("balance", &Payment::balance),
+		cbor::field("settled", &Payment::settled)
+	);
+};
+
+struct Envelope {
+	template<typename Encoder_>
+	static constexpr auto build(Encoder_& encoder) -> void {
+		encoder.write_map(3);
+		encoder.write_string("type");
+		encoder.write_string("tick");
+		encoder.write_string("seq");
+		encoder.write_uint_hole();
+		encoder.write_string("delta");
+		encoder.write_int_hole(4);
+	}
+};
+
+struct HashingBlobHandler : cbor::BlobHandler {
+	uint64_t sum = 0;
+	size_t chunks = 0;
+	bool finished = false;
+	
+	auto begin(uint64_t) -> uint64_t override {
+		return 42;
+	}
+	
+	auto chunk(uint64_t handle, const uint8_t* data, size_t size) -> void override {
+		assert(handle == 42 && size <= 256);
+		for(size_t i = 0; i < size; ++i) {
+			sum += data[i];
+		}
+		++chunks;
+	}
+	
+	auto end(uint64_t) -> void override {
+		finished = true;
+	}
+};
 
 int main() {
 	cbor::OutputDynamic output;
@@ -87,6 +182,1310 @@ int main() {
 		cbor::OutputDynamic output2;
 		cbor::Encoder encoder2(output2);
 		encoder2.write_object(result);
+		
+		unsigned char span_data[64];
+		assert(cbor::encoded_size(result) == output2.size());
+		cbor::OutputSpan output_span(span_data, cbor::encoded_size(result));
+		cbor::Encoder span_encoder(output_span);
+		span_encoder.write_object(result);
+		assert(output_span.size() == output2.size() && std::memcmp(span_data, output2.data(), output2.size()) == 0);
+		
+		cbor::OutputCounter output_counter;
+		cbor::Encoder counter_encoder(output_counter);
+		counter_encoder.write_object(result);
+		assert(output_counter.size() == output2.size());
+	}
+	
+	{ // typed decoding
+		cbor::OutputDynamic output3;
+		cbor::Encoder encoder3(output3);
+		encoder3.write_map(4);
+		{
+			encoder3.write_string("unknown");
+			encoder3.write_array(2);
+			{
+				encoder3.write_map(1);
+				encoder3.write_string("a");
+				encoder3.write_bytes((const uint8_t*)"abc", 3);
+				encoder3.write_int(-5);
+			}
+			encoder3.write_string("age");
+			encoder3.write_int(42);
+			encoder3.write_string("id");
+			encoder3.write_string("p-1");
+			encoder3.write_string("addresses");
+			encoder3.write_array(2);
+			{
+				encoder3.write_map(2);
+				encoder3.write_string("city");
+				encoder3.write_string("Oslo");
+				encoder3.write_string("zip");
+				encoder3.write_int(150);
+				encoder3.write_map(1);
+				encoder3.write_string("zip");
+				encoder3.write_null();
+			}
+		}
+		
+		cbor::Input input(output3.data(), output3.size());
+		auto person = cbor::decode<Person>(input);
+		assert(input.is_empty());
+		assert(person.age == 42 && person.name.empty());
+		assert(std::get<std::string>(person.id) == "p-1");
+		assert(person.addresses.size() == 2);
+		assert(person.addresses[0].city == "Oslo" && person.addresses[0].zip == 150);
+		assert(person.addresses[1].city.empty() && !person.addresses[1].zip);
+		
+		person.flags["admin"] = true;
+		person.id = int64_t{-7};
+		cbor::OutputDynamic output4;
+		cbor::encode(output4, person);
+		cbor::Input input2(output4.data(), output4.size());
+		auto person2 = cbor::decode<Person>(input2);
+		assert(std::get<int64_t>(person2.id) == -7 && person2.flags.at("admin"));
+		assert(person2.addresses[0].zip == 150 && !person2.addresses[1].zip);
+	}
+	
+	{ // message templates
+		constexpr auto envelope = cbor::make_template<Envelope>();
+		static_assert(envelope.size() == 35 && envelope.holes.size() == 2);
+		
+		auto message = envelope.instantiate();
+		envelope.holes[0].patch_uint(message.data(), 1234567890123ULL);
+		envelope.holes[1].patch_int(message.data(), -3);
+		
+		cbor::Input input(message.data(), (int)message.size());
+		cbor::Decoder decoder(input);
+		auto result = decoder.run();
+		auto const& map_value = result->as_map();
+		assert(map_value.at("type")->as_string() == "tick");
+		assert(map_value.at("seq")->as<cbor::ObjectType::ExtraInt>().second == 1234567890123ULL);
+		assert(map_value.at("delta")->as_int() == -3);
+	}
+	
+	{ // reusable dynamic output
+		cbor::OutputDynamic output5(cbor::Allocator::thread_pool());
+		cbor::Encoder encoder5(output5);
+		encoder5.write_string(std::string(1000, 'x'));
+		assert(output5.size() == 1003 && output5.capacity() == 1024);
+		
+		output5.reset();
+		encoder5.write_int(1);
+		assert(output5.size() == 1 && output5.capacity() == 1024);
+		
+		cbor::OutputDynamic output6(std::move(output5));
+		assert(output6.size() == 1 && output6.data()[0] == 1 && output5.size() == 0);
+		
+		auto buffer = output6.release();
+		assert(buffer.size() == 1 && buffer.capacity() == 1024 && buffer.data()[0] == 1);
+		assert(output6.size() == 0 && output6.capacity() == cbor::OutputDynamic::inline_capacity);
+	}
+	
+	{ // segmented output
+		std::string blob(5000, 'b');
+		cbor::OutputSegmented output7(16, 1024);
+		cbor::Encoder encoder7(output7);
+		encoder7.write_array(3);
+		encoder7.write_string("a string spanning several chunks");
+		encoder7.write_bytes_ref((const uint8_t*)blob.data(), (uint32_t)blob.size());
+		encoder7.write_int(7);
+		assert(output7.size() == 1 + 34 + 3 + 5000 + 1);
+		assert(output7.slices()[3].data == (const unsigned char*)blob.data());
+		
+		int fds[2];
+		assert(pipe(fds) == 0);
+		output7.flush_to_fd(fds[1]);
+		close(fds[1]);
+		assert(output7.size() == 0 && output7.slices().empty());
+		
+		std::vector<unsigned char> received(6000);
+		size_t received_size = 0;
+		for(ssize_t count; (count = read(fds[0], received.data() + received_size, received.size() - received_size)) > 0;) {
+			received_size += count;
+		}
+		close(fds[0]);
+		
+		cbor::Input input(received.data(), (int)received_size);
+		cbor::Decoder decoder(input);
+		auto result = decoder.run();
+		auto const& array_value = result->as_array();
+		assert(array_value[1]->as_bytes().size() == 5000 && array_value[2]->as_int() == 7);
+	}
+	
+	{ // memory-mapped file output
+		auto path = "/tmp/cbor_cpp_tests_mapped.cbor";
+		{
+			cbor::OutputMapped output8(path, 4096, true);
+			cbor::Encoder encoder8(output8);
+			encoder8.write_array(100);
+			for(int i = 0; i < 100; ++i) {
+				encoder8.write_string(std::string(100, (char)('a' + i % 26)));
+			}
+			assert(output8.size() == 2 + 100 * 102 && output8.capacity() == 16384);
+			output8.close();
+		}
+		
+		FILE* file = fopen(path, "rb");
+		std::vector<unsigned char> file_data(20000);
+		auto file_size = fread(file_data.data(), 1, file_data.size(), file);
+		fclose(file);
+		remove(path);
+		assert(file_size == 2 + 100 * 102);
+		
+		cbor::Input input(file_data.data(), (int)file_size);
+		cbor::Decoder decoder(input);
+		auto result = decoder.run();
+		assert(result->as_array().size() == 100 && result->as_array()[99]->as_string() == std::string(100, 'v'));
+	}
+	
+	{ // streaming input
+		cbor::OutputDynamic output9;
+		cbor::Encoder encoder9(output9);
+		for(int i = 0; i < 3; ++i) {
+			encoder9.write_array(2);
+			encoder9.write_int(i);
+			encoder9.write_string(std::string(1000, (char)('x' + i)));
+		}
+		
+		std::istringstream stream(std::string((const char*)output9.data(), output9.size()));
+		cbor::InputIstream input(stream, 64);
+		cbor::Decoder decoder(input);
+		int count = 0;
+		while(auto item = decoder.next()) {
+			auto const& array_value = item->as_array();
+			assert(array_value[0]->as_int() == count && array_value[1]->as_string() == std::string(1000, (char)('x' + count)));
+			++count;
+		}
+		assert(count == 3);
+	}
+	
+	{ // blob handler
+		std::vector<uint8_t> blob(1000, 3);
+		cbor::OutputDynamic output10;
+		cbor::Encoder encoder10(output10);
+		encoder10.write_array(2);
+		encoder10.write_bytes(blob.data(), (uint32_t)blob.size());
+		encoder10.write_bytes(blob.data(), 10);
+		
+		HashingBlobHandler handler;
+		cbor::Input input(output10.data(), (int)output10.size());
+		cbor::Decoder decoder(input);
+		decoder.set_blob_handler(handler, 100, 256);
+		auto result = decoder.run();
+		auto const& array_value = result->as_array();
+		assert(array_value[0]->as_blob().handle == 42 && array_value[0]->as_blob().size == 1000);
+		assert(array_value[1]->as_bytes().size() == 10);
+		assert(handler.sum == 3000 && handler.chunks == 4 && handler.finished);
+	}
+	
+	{ // single-producer single-consumer ring
+		constexpr size_t capacity = 256;
+		std::vector<uint64_t> memory(cbor::RingBuffer::required_size(capacity) / sizeof(uint64_t) + 8);
+		auto aligned = (void*)(((uintptr_t)memory.data() + 63) & ~(uintptr_t)63);
+		auto ring = cbor::RingBuffer::create(aligned, capacity);
+		
+		std::thread producer([ring] {
+			cbor::OutputRing output(*ring);
+			cbor::Encoder encoder(output);
+			for(int i = 0; i < 1000; ++i) {
+				encoder.write_array(2);
+				encoder.write_int(i);
+				encoder.write_string(std::string(i % 50, 'r'));
+				output.commit();
+			}
+		});
+		
+		cbor::InputRing input(*ring);
+		cbor::Decoder decoder(input);
+		for(int i = 0; i < 1000;) {
+			auto item = decoder.next();
+			if(!item) {
+				std::this_thread::yield();
+				continue;
+			}
+			auto const& array_value = item->as_array();
+			assert(array_value[0]->as_int() == i && array_value[1]->as_string() == std::string(i % 50, 'r'));
+			input.release();
+			++i;
+		}
+		producer.join();
+		assert(input.is_empty());
+	}
+	
+	{ // framing
+		assert(cbor::crc32c(0, "123456789", 9) == 0xe3069283);
+		
+		cbor::FrameWriter writer;
+		cbor::Encoder encoder(writer);
+		for(int i = 0; i < 5; ++i) {
+			writer.begin_frame();
+			encoder.write_array(2);
+			encoder.write_int(i);
+			encoder.write_string(std::string(i * 30, 'f'));
+			writer.end_frame();
+		}
+		assert(writer.frame_count() == 5 && !writer.should_flush());
+		std::vector<uint8_t> stream(writer.data(), writer.data() + writer.size());
+		
+		cbor::FrameSplitter splitter;
+		cbor::Frame frame;
+		int count = 0;
+		for(size_t offset = 0; offset < stream.size(); offset += 37) {
+			splitter.feed(stream.data() + offset, std::min<size_t>(37, stream.size() - offset));
+			while(splitter.next(frame)) {
+				cbor::Input input((void*)frame.data, (int)frame.size);
+				cbor::Decoder decoder(input);
+				auto result = decoder.run();
+				auto const& array_value = result->as_array();
+				assert(array_value[0]->as_int() == count && array_value[1]->as_string() == std::string(count * 30, 'f'));
+				++count;
+			}
+		}
+		assert(count == 5);
+		
+		stream[10] ^= 1;
+		cbor::FrameSplitter corrupted;
+		corrupted.feed(stream.data(), stream.size());
+		bool thrown = false;
+		try {
+			corrupted.next(frame);
+		} catch(cbor::DecodeException const&) {
+			thrown = true;
+		}
+		assert(thrown);
+	}
+	
+	{ // parallel encoding
+		auto root = cbor::Object::create_map(0);
+		auto& root_map = root->as<cbor::ObjectType::Map>();
+		for(int i = 0; i < 3; ++i) {
+			auto rows = cbor::Object::create_array(0);
+			for(int j = 0; j < 500; ++j) {
+				auto row = cbor::Object::create_map(0);
+				row->as<cbor::ObjectType::Map>()["id"] = cbor::Object::from_int(i * 1000 + j);
+				row->as<cbor::ObjectType::Map>()["name"] = cbor::Object::from_string(std::string(j % 40, 'p'));
+				rows->as<cbor::ObjectType::Array>().push_back(row);
+			}
+			root_map["table" + std::to_string(i)] = rows;
+		}
+		root_map["empty"] = cbor::Object::create_array(0);
+		// keys whose deterministic order differs from the order of std::map
+		auto wide = cbor::Object::create_map(0);
+		for(int i = 0; i < 600; ++i) {
+			wide->as<cbor::ObjectType::Map>()["k" + std::to_string(i)] = cbor::Object::from_int(i);
+		}
+		wide->array_or_map_size = 600;
+		root_map["wide"] = wide;
+		
+		cbor::OutputDynamic sequential;
+		cbor::Encoder encoder(sequential);
+		encoder.write_object(root);
+		for(size_t threads: {1, 2, 4, 7}) {
+			cbor::OutputDynamic parallel;
+			cbor::encode_parallel(parallel, root, threads, 3);
+			assert(parallel.bytes() == sequential.bytes());
+		}
+		
+		cbor::EncodeOptions options;
+		options.deterministic = true;
+		cbor::OutputDynamic ordered;
+		cbor::Encoder ordered_encoder(ordered);
+		ordered_encoder.set_deterministic(true);
+		ordered_encoder.write_object(root);
+		assert(ordered.bytes() != sequential.bytes());
+		for(size_t threads: {1, 2, 4, 7}) {
+			cbor::OutputDynamic parallel;
+			cbor::encode_parallel(parallel, root, options, threads, 3);
+			assert(parallel.bytes() == ordered.bytes());
+		}
+		
+		// invalid UTF-8 inside a task is rejected when the options ask for validation
+		root_map["table1"]->as<cbor::ObjectType::Array>()[250]->as<cbor::ObjectType::Map>()["name"] = cbor::Object::from_string("\xc3");
+		options.validate_utf8 = true;
+		for(size_t threads: {1, 2, 4, 7}) {
+			cbor::OutputDynamic parallel;
+			cbor::encode_parallel(parallel, root, threads, 3);
+			auto thrown = false;
+			try {
+				cbor::encode_parallel(parallel, root, options, threads, 3);
+			} catch(cbor::EncodeException const&) {
+				thrown = true;
+			}
+			assert(thrown);
+		}
+	}
+	
+	{ // parallel decoding
+		cbor::OutputDynamic output11;
+		cbor::Encoder encoder11(output11);
+		encoder11.write_array(1000);
+		for(int i = 0; i < 1000; ++i) {
+			if(i % 100 == 0) {
+				encoder11.write_tag(1);
+				encoder11.write_int(i);
+			} else if(i % 2 == 0) {
+				encoder11.write_map(2);
+				encoder11.write_string("id");
+				encoder11.write_int(i);
+				encoder11.write_string("tags");
+				encoder11.write_array(2);
+				encoder11.write_string("a");
+				encoder11.write_bool(i % 4 == 0);
+			} else {
+				encoder11.write_string(std::string(i % 30, 'd'));
+			}
+		}
+		
+		for(size_t threads: {1, 2, 5}) {
+			auto result = cbor::decode_parallel(output11.data(), output11.size(), threads, 3);
+			auto const& array_value = result->as_array();
+			assert(array_value.size() == 1000 && array_value[100]->as_tag().tag == 1);
+			assert(array_value[100]->tagged_item()->as_int() == 100);
+			assert(array_value[998]->as_map().at("id")->as_int() == 998);
+			cbor::OutputDynamic reencoded;
+			cbor::encode_parallel(reencoded, result, 1);
+			assert(reencoded.bytes() == output11.bytes());
+		}
+		
+		cbor::OutputDynamic map_output;
+		cbor::Encoder map_encoder(map_output);
+		map_encoder.write_map(50);
+		for(int i = 0; i < 50; ++i) {
+			map_encoder.write_string("key" + std::to_string(i));
+			map_encoder.write_int(i);
+		}
+		auto map_result = cbor::decode_parallel(map_output.data(), map_output.size(), 4);
+		assert(map_result->as_map().size() == 50 && map_result->as_map().at("key42")->as_int() == 42);
+	}
+	
+	{ // resumable encoding
+		auto root = cbor::Object::create_array(0);
+		auto node = root;
+		for(int i = 0; i < 1000; ++i) {
+			auto child = cbor::Object::create_map(0);
+			node->as<cbor::ObjectType::Array>().push_back(child);
+			node->as<cbor::ObjectType::Array>().push_back(cbor::Object::from_string(std::string(i % 20, 'n')));
+			child->as<cbor::ObjectType::Map>()["next"] = cbor::Object::create_array(0);
+			child->as<cbor::ObjectType::Map>()["bytes"] = cbor::Object::from_bytes(cbor::BytesValue(i % 9, 'b'));
+			node = child->as<cbor::ObjectType::Map>()["next"];
+		}
+		
+		cbor::OutputDynamic whole;
+		cbor::Encoder encoder(whole);
+		encoder.write_object(root);
+		assert(whole.size() == cbor::encoded_size(root));
+		
+		cbor::OutputDynamic chunked;
+		cbor::ResumableEncoder resumable(root);
+		while(!resumable.done()) {
+			auto written = resumable.encode_some(chunked, 7);
+			assert(written <= 7 && (written == 7 || resumable.done()));
+		}
+		assert(chunked.bytes() == whole.bytes());
+	}
+	
+	{ // cached re-encoding
+		auto root = cbor::Object::create_map(0);
+		for(int i = 0; i < 20; ++i) {
+			auto section = cbor::Object::create_array(0);
+			for(int j = 0; j < 50; ++j) {
+				auto entry = cbor::Object::create_map(0);
+				entry->as<cbor::ObjectType::Map>()["value"] = cbor::Object::from_int(i * j);
+				section->as<cbor::ObjectType::Array>().push_back(entry);
+			}
+			root->as<cbor::ObjectType::Map>()["section" + std::to_string(i)] = section;
+		}
+		auto sequential = [&] {
+			cbor::OutputDynamic output;
+			cbor::Encoder(output).write_object(root);
+			return output.bytes();
+		};
+		
+		cbor::EncodeCache cache(256);
+		cbor::OutputDynamic first;
+		cache.encode(first, root);
+		assert(first.bytes() == sequential());
+		
+		auto const& section = root->as_map().at("section7");
+		cache.set(section->as_array()[3], "value", cbor::Object::from_string("changed"));
+		cache.push_back(section, cbor::Object::from_bool(true));
+		cache.erase(root, "section2");
+		cache.set(root, "extra", cbor::Object::create_array(0));
+		cbor::OutputDynamic second;
+		cache.encode(second, root);
+		assert(second.bytes() == sequential());
+		
+		cbor::OutputDynamic third;
+		cache.encode(third, root);
+		assert(third.bytes() == second.bytes());
+		
+		// a map behind a tag is tracked like any container
+		auto tagged = cbor::Object::from_tag(cbor::TagValue{1, cbor::Object::create_map(0)});
+		cache.push_back(section, tagged);
+		cbor::OutputDynamic fourth;
+		cache.encode(fourth, root);
+		assert(fourth.bytes() == sequential());
+		cache.set(tagged->tagged_item(), "key", cbor::Object::from_int(1));
+		cbor::OutputDynamic fifth;
+		cache.encode(fifth, root);
+		assert(fifth.bytes() == sequential());
+		
+		// nested far deeper than the call stack allows
+		auto deep = cbor::Object::create_array(0);
+		auto innermost = deep;
+		for(int i = 0; i < 200000; ++i) {
+			auto child = cbor::Object::create_array(0);
+			innermost->as<cbor::ObjectType::Array>().push_back(child);
+			innermost->array_or_map_size = 1;
+			innermost = child;
+		}
+		cbor::EncodeCache deep_cache(256);
+		cbor::OutputDynamic deep_cached;
+		deep_cache.encode(deep_cached, deep);
+		cbor::OutputDynamic deep_plain;
+		cbor::Encoder(deep_plain).write_object(deep);
+		assert(deep_cached.bytes() == deep_plain.bytes());
+		deep_cache.push_back(innermost, cbor::Object::from_int(1));
+		deep_cached.reset();
+		deep_cache.encode(deep_cached, deep);
+		deep_plain.reset();
+		cbor::Encoder(deep_plain).write_object(deep);
+		assert(deep_cached.bytes() == deep_plain.bytes() && deep_cached.size() == 200000 + 2);
+	}
+	
+	{ // interned decoding
+		cbor::OutputDynamic output12;
+		cbor::Encoder encoder12(output12);
+		encoder12.write_array(100);
+		for(int i = 0; i < 100; ++i) {
+			encoder12.write_map(2);
+			encoder12.write_string("city");
+			encoder12.write_string("Springfield");
+			encoder12.write_string("labels");
+			encoder12.write_array(2);
+			encoder12.write_string(i % 2 == 0 ? "even" : "odd");
+			encoder12.write_int(7);
+		}
+		
+		cbor::ObjectInterner interner;
+		cbor::Input input(output12.data(), (int)output12.size());
+		cbor::Decoder decoder(input);
+		decoder.set_interner(interner);
+		auto result = decoder.run();
+		auto const& array_value = result->as_array();
+		// containers are shared only while their entry stays in the table, leaves of equal content always are
+		assert(array_value[0].get() != array_value[1].get());
+		assert(array_value[0]->as_map().at("city").get() == array_value[1]->as_map().at("city").get());
+		assert(array_value[0]->as_map().at("labels")->as_array()[1].get() == array_value[1]->as_map().at("labels")->as_array()[1].get());
+		assert(interner.hits() > 0);
+		
+		cbor::OutputDynamic reencoded;
+		cbor::Encoder(reencoded).write_object(result);
+		assert(reencoded.bytes() == output12.bytes());
+	}
+	
+	{ // non-throwing api
+		cbor::OutputDynamic output13;
+		cbor::Encoder encoder13(output13);
+		encoder13.write_map(3);
+		encoder13.write_string("a");
+		encoder13.write_int(1);
+		encoder13.write_string("a");
+		encoder13.write_array(2);
+		encoder13.write_tag(0);
+		encoder13.write_string("x");
+		encoder13.write_int(9);
+		encoder13.write_string("b");
+		encoder13.write_bytes((const uint8_t*)"yz", 2);
+		
+		cbor::PObject result;
+		assert(!cbor::try_decode(output13.data(), output13.size(), result));
+		assert(result->as_map().size() == 2 && result->as_map().at("a")->as_array().size() == 2);
+		
+		auto truncated = cbor::try_decode(output13.data(), output13.size() - 1, result);
+		assert(truncated.code == cbor::ErrorCode::UnexpectedEnd && truncated.offset == output13.size() - 1);
+		
+		const uint8_t bad_key[] = {0xa1, 0x01, 0x02};
+		auto key_error = cbor::try_decode(bad_key, sizeof(bad_key), result);
+		assert(key_error.code == cbor::ErrorCode::InvalidMapKey && key_error.offset == 1);
+		
+		const uint8_t bad_head[] = {0x82, 0x01, 0x1c};
+		assert(cbor::try_decode(bad_head, sizeof(bad_head), result).code == cbor::ErrorCode::InvalidHead);
+		
+		const uint8_t trailing[] = {0x01, 0x02};
+		auto trailing_error = cbor::try_decode(trailing, sizeof(trailing), result);
+		assert(trailing_error.code == cbor::ErrorCode::TrailingData && trailing_error.offset == 1);
+		assert(cbor::try_decode(trailing, 0, result).code == cbor::ErrorCode::Empty);
+		
+		uint8_t small[4];
+		cbor::OutputSpan span(small, sizeof(small));
+		assert(cbor::try_encode(span, result).code == cbor::ErrorCode::Overflow && span.size() == 0);
+		assert(cbor::try_encode(span, cbor::Object::from_int(5)).code == cbor::ErrorCode::None && span.size() == 1);
+		assert(cbor::try_encode(span, cbor::Object::from_blob({1, 2})).code == cbor::ErrorCode::InvalidObject);
+	}
+	
+	{ // statistics
+		auto before = cbor::decoder_stats();
+		cbor::OutputDynamic output14;
+		cbor::Encoder encoder14(output14);
+		encoder14.write_array(2);
+		encoder14.write_array(1);
+		encoder14.write_string(std::string(100, 's'));
+		encoder14.write_int(3);
+		cbor::Input input(output14.data(), (int)output14.size());
+		cbor::Decoder decoder(input);
+		auto result = decoder.run();
+		auto after = cbor::decoder_stats();
+		
+		auto string_data = (size_t)cbor::DecoderState::StringData;
+		if(CBOR_STATS) {
+			assert(after.state_steps[string_data] == before.state_steps[string_data] + 1);
+			assert(after.bytes_copied == before.bytes_copied + 100 && after.allocations == before.allocations + 5);
+			assert(after.max_depth >= 2);
+		} else {
+			assert(after.state_steps[string_data] == 0 && after.bytes_copied == 0);
+		}
+		
+		auto string_usage = result->as_array()[0]->as_array()[0]->memory_usage();
+		assert(string_usage > 100 && result->memory_usage() > string_usage + cbor::Object::from_int(3)->memory_usage());
+	}
+	
+	{ // decode limits
+		cbor::OutputDynamic output15;
+		cbor::Encoder encoder15(output15);
+		encoder15.write_array(2);
+		encoder15.write_array(1);
+		encoder15.write_array(1);
+		encoder15.write_int(1);
+		encoder15.write_string("abcdef");
+		
+		auto decode_limited = [&](cbor::DecodeLimits const& limits) {
+			cbor::Input input(output15.data(), (int)output15.size());
+			cbor::Decoder decoder(input);
+			decoder.set_limits(limits);
+			try {
+				return decoder.run() != nullptr;
+			} catch(cbor::DecodeException const&) {
+				return false;
+			}
+		};
+		cbor::DecodeLimits limits;
+		assert(decode_limited(limits));
+		limits.max_depth = 2;
+		assert(!decode_limited(limits));
+		limits.max_depth = 3;
+		limits.max_items = 4;
+		assert(!decode_limited(limits));
+		limits.max_items = 5;
+		limits.max_string_length = 5;
+		assert(!decode_limited(limits));
+		limits.max_string_length = 6;
+		assert(decode_limited(limits));
+		
+		cbor::PObject result;
+		assert(!cbor::try_decode(output15.data(), output15.size(), result, limits));
+		limits.max_bytes = result->memory_usage() / 2;
+		assert(!decode_limited(limits));
+		auto error = cbor::try_decode(output15.data(), output15.size(), result, limits);
+		assert(error.code == cbor::ErrorCode::LimitExceeded);
+		
+		// an announced count is rejected before any of its items is read
+		const uint8_t huge_array[] = {0x9a, 0x7f, 0xff, 0xff, 0xff};
+		cbor::DecodeLimits item_limits;
+		item_limits.max_items = 1000;
+		error = cbor::try_decode(huge_array, sizeof(huge_array), result, item_limits);
+		assert(error.code == cbor::ErrorCode::LimitExceeded && error.offset == 0);
+	}
+	
+	{ // utf-8 validation
+		std::string text = std::string(40, 'k') + "\xc3\xa9t\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80" + std::string(40, 'k');
+		const char* invalid[] = {"\xc0\x80", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xe2\x82", "\x80", "\xff"};
+		// the same vectors through every implementation this CPU has, placed across the 16 and 32 byte blocks
+		auto best_isa = cbor::utf8_isa();
+		size_t isa_count = 0;
+		for(auto isa: {cbor::Utf8Isa::Scalar, cbor::Utf8Isa::Ssse3, cbor::Utf8Isa::Avx2}) {
+			if(!cbor::set_utf8_isa(isa)) {
+				continue;
+			}
+			++isa_count;
+			assert(cbor::utf8_isa() == isa);
+			assert(cbor::is_valid_utf8(text.data(), text.size()) && cbor::is_valid_utf8("key", 3));
+			for(size_t pad = 0; pad < 80; ++pad) {
+				// two-byte characters and ASCII after the ASCII prefix move the sequence through a whole block
+				auto head = text.substr(0, 40);
+				for(size_t i = 0; i < pad / 2; ++i) {
+					head += "\xc3\xa9";
+				}
+				if(pad % 2 != 0) {
+					head += 'a';
+				}
+				auto valid = head + text.substr(40);
+				assert(cbor::is_valid_utf8(valid.data(), valid.size()));
+				for(auto sequence: invalid) {
+					auto broken = head + sequence + text.substr(40);
+					assert(!cbor::is_valid_utf8(broken.data(), broken.size()));
+				}
+			}
+			for(auto sequence: invalid) {
+				auto broken = text.substr(0, 50) + sequence + text.substr(50);
+				assert(!cbor::is_valid_utf8(broken.data(), broken.size()));
+				auto at_end = text + sequence;
+				assert(!cbor::is_valid_utf8(at_end.data(), at_end.size()));
+			}
+		}
+		assert(isa_count >= 1 && cbor::set_utf8_isa(best_isa));
+		
+		cbor::OutputDynamic output16;
+		cbor::Encoder encoder16(output16);
+		encoder16.set_utf8_validation(true);
+		encoder16.write_map(1);
+		encoder16.write_string(text);
+		bool thrown = false;
+		try {
+			encoder16.write_string("\xe2\x82", 2);
+		} catch(cbor::EncodeException const&) {
+			thrown = true;
+		}
+		assert(thrown);
+		encoder16.set_utf8_validation(false);
+		encoder16.write_string("\xe2\x82", 2);
+		
+		auto decode_checked = [&](bool validate) {
+			cbor::Input input(output16.data(), (int)output16.size());
+			cbor::Decoder decoder(input);
+			decoder.set_utf8_validation(validate);
+			try {
+				return decoder.run() != nullptr;
+			} catch(cbor::DecodeException const&) {
+				return false;
+			}
+		};
+		assert(decode_checked(false) && !decode_checked(true));
+	}
+	
+	{ // deterministic encoding
+		auto root = cbor::Object::create_map(0);
+		auto inner = cbor::Object::create_map(0);
+		std::vector<std::string> keys = {"b", "aa", "a", "ccc", "\xc3\xa9", "ab", std::string(300, 'z'), ""};
+		for(auto const& key: keys) {
+			root->as<cbor::ObjectType::Map>()[key] = cbor::Object::from_int((int)key.size());
+			inner->as<cbor::ObjectType::Map>()[key] = cbor::Object::from_bool(true);
+		}
+		root->as<cbor::ObjectType::Map>()["inner"] = inner;
+		
+		cbor::OutputDynamic output17;
+		cbor::Encoder encoder17(output17);
+		encoder17.set_deterministic(true);
+		encoder17.write_object(root);
+		
+		keys.push_back("inner");
+		auto sorted = keys;
+		std::sort(sorted.begin(), sorted.end(), cbor::deterministic_key_less);
+		assert(sorted[0].empty() && sorted[1] == "a" && sorted[2] == "b" && sorted[3] == "aa");
+		cbor::OutputDynamic expected;
+		cbor::Encoder expected_encoder(expected);
+		expected_encoder.write_map((int)sorted.size());
+		for(auto const& key: sorted) {
+			expected_encoder.write_string(key);
+			if(key == "inner") {
+				expected_encoder.write_map((int)sorted.size() - 1);
+				for(auto const& inner_key: sorted) {
+					if(inner_key != "inner") {
+						expected_encoder.write_string(inner_key);
+						expected_encoder.write_bool(true);
+					}
+				}
+			} else {
+				expected_encoder.write_int((int)key.size());
+			}
+		}
+		assert(output17.bytes() == expected.bytes());
+		
+		cbor::OutputDynamic floats;
+		cbor::Encoder float_encoder(floats);
+		float_encoder.write_double(1.5);
+		float_encoder.write_double(100000.0);
+		float_encoder.write_double(1.1);
+		float_encoder.write_double(5.960464477539063e-8);
+		float_encoder.write_double(0.0 / 0.0);
+		float_encoder.write_double(-1.0 / 0.0);
+		std::vector<unsigned char> expected_floats = {
+			0xf9, 0x3e, 0x00,
+			0xfa, 0x47, 0xc3, 0x50, 0x00,
+			0xfb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a,
+			0xf9, 0x00, 0x01,
+			0xf9, 0x7e, 0x00,
+			0xf9, 0xfc, 0x00,
+		};
+		assert(floats.bytes() == expected_floats);
+	}
+	
+	{ // structural hashing
+		auto encode_entries = [](bool reversed) {
+			cbor::OutputDynamic output;
+			cbor::Encoder encoder(output);
+			encoder.write_array(2);
+			encoder.write_map(2);
+			for(int i = 0; i < 2; ++i) {
+				if((i == 0) != reversed) {
+					encoder.write_string("first");
+					encoder.write_int(-7);
+				} else {
+					encoder.write_string("second");
+					encoder.write_bytes((const uint8_t*)"\x01\x02", 2);
+				}
+			}
+			encoder.write_tag(1);
+			encoder.write_int((uint64_t)5);
+			return output.bytes();
+		};
+		auto forward = encode_entries(false);
+		auto backward = encode_entries(true);
+		assert(forward != backward);
+		
+		uint64_t forward_hash = 0;
+		uint64_t backward_hash = 0;
+		assert(!cbor::hash_encoded(forward.data(), forward.size(), forward_hash));
+		assert(!cbor::hash_encoded(backward.data(), backward.size(), backward_hash));
+		assert(forward_hash == backward_hash);
+		
+		cbor::Input input(forward.data(), (int)forward.size());
+		auto decoded = cbor::Decoder(input).run();
+		assert(cbor::hash(*decoded) == forward_hash);
+		
+		// integers are compared by value, not by the width they were written with
+		const uint8_t wide_five[] = {0x82, 0xa2, 0x65, 'f', 'i', 'r', 's', 't', 0x26, 0x66, 's', 'e', 'c', 'o', 'n', 'd', 0x42, 0x01, 0x02, 0xc1, 0x1b, 0, 0, 0, 0, 0, 0, 0, 5};
+		uint64_t wide_hash = 0;
+		assert(!cbor::hash_encoded(wide_five, sizeof(wide_five), wide_hash) && wide_hash == forward_hash);
+		cbor::Input wide_input((void*)wide_five, (int)sizeof(wide_five));
+		auto wide = cbor::Decoder(wide_input).run();
+		assert(wide->as_array()[1]->tagged_item()->object_type() == cbor::ObjectType::ExtraInt && cbor::equal(*wide, *decoded));
+		
+		cbor::Input changed_input(forward.data(), (int)forward.size());
+		auto changed = cbor::Decoder(changed_input).run();
+		changed->as_array()[0]->as<cbor::ObjectType::Map>()["first"] = cbor::Object::from_int(-8);
+		assert(!cbor::equal(*changed, *decoded) && cbor::hash(*changed) != forward_hash);
+		
+		cbor::HashCache cache;
+		assert(cache.hash(decoded) == forward_hash && cache.size() == 3);
+		assert(cache.hash(decoded) == forward_hash && cache.size() == 3);
+		
+		uint64_t unused = 0;
+		assert(cbor::hash_encoded(forward.data(), forward.size() - 1, unused).code == cbor::ErrorCode::UnexpectedEnd);
+	}
+	
+	{ // json transcoding
+		std::string json = "{\"id\": 7, \"neg\": -300, \"ratio\": 0.5, \"name\": \"a\\\"b\\u00e9\\n\", "
+			"\"tags\": [true, false, null, []], \"nested\": {}}";
+		cbor::OutputDynamic output18;
+		assert(!cbor::json_to_cbor(json.data(), json.size(), output18));
+		
+		cbor::Input input(output18.data(), (int)output18.size());
+		auto result = cbor::Decoder(input).run();
+		auto const& map_value = result->as_map();
+		assert(map_value.size() == 6 && map_value.at("id")->as_int() == 7 && map_value.at("neg")->as_int() == -300);
+		assert(map_value.at("name")->as_string() == "a\"b\xc3\xa9\n" && map_value.at("tags")->as_array().size() == 4);
+		assert(map_value.at("ratio")->as_special() == 0x3800);
+		
+		cbor::OutputDynamic text;
+		assert(!cbor::cbor_to_json(output18.data(), output18.size(), text));
+		std::string expected = "{\"id\":7,\"neg\":-300,\"ratio\":0.5,\"name\":\"a\\\"b\xc3\xa9\\n\","
+			"\"tags\":[true,false,null,[]],\"nested\":{}}";
+		assert(std::string((const char*)text.data(), text.size()) == expected);
+		
+		cbor::OutputDynamic bytes_text;
+		cbor::Encoder bytes_encoder(bytes_text);
+		bytes_encoder.write_bytes((const uint8_t*)"\xfb\xff", 2);
+		cbor::OutputDynamic base64;
+		assert(!cbor::cbor_to_json(bytes_text.data(), bytes_text.size(), base64));
+		assert(std::string((const char*)base64.data(), base64.size()) == "\"-_8\"");
+		
+		cbor::OutputDynamic rejected;
+		const char* invalid[] = {"[1,]", "{\"a\" 1}", "[01]", "\"open", "[1 2]", "{\"a\":[}]"};
+		for(auto document: invalid) {
+			assert(cbor::json_to_cbor(document, strlen(document), rejected).code == cbor::ErrorCode::InvalidJson);
+		}
+		const uint8_t integer_key[] = {0xa1, 0x01, 0x02};
+		assert(cbor::cbor_to_json(integer_key, sizeof(integer_key), rejected).code == cbor::ErrorCode::InvalidMapKey);
+		
+		// a tag is a prefix of the item after it and takes no slot of its own
+		auto tagged_json = [](std::vector<uint8_t> bytes) {
+			cbor::OutputDynamic tagged_text;
+			assert(!cbor::cbor_to_json(bytes.data(), bytes.size(), tagged_text));
+			return std::string((const char*)tagged_text.data(), tagged_text.size());
+		};
+		assert(tagged_json({0xc1, 0x18, 0x7b}) == "123");
+		assert(tagged_json({0x81, 0xc1, 0x18, 0x7b}) == "[123]");
+		assert(tagged_json({0x82, 0xc1, 0xc2, 0x01, 0x02}) == "[1,2]");
+		assert(tagged_json({0xa1, 0x61, 't', 0xc1, 0x01}) == "{\"t\":1}");
+		const uint8_t dangling_tag[] = {0x81, 0xc1};
+		assert(cbor::cbor_to_json(dangling_tag, sizeof(dangling_tag), rejected).code == cbor::ErrorCode::UnexpectedEnd);
+		
+		// numbers beyond the range of double become infinities or zeros of the same sign
+		auto number_cbor = [](std::string number) {
+			cbor::OutputDynamic number_output;
+			assert(!cbor::json_to_cbor(number.data(), number.size(), number_output));
+			return number_output.bytes();
+		};
+		assert(number_cbor("1e400") == std::vector<unsigned char>({0xf9, 0x7c, 0x00}));
+		assert(number_cbor("-1e400") == std::vector<unsigned char>({0xf9, 0xfc, 0x00}));
+		assert(number_cbor("0.0001e400") == std::vector<unsigned char>({0xf9, 0x7c, 0x00}));
+		assert(number_cbor("1" + std::string(400, '0')) == std::vector<unsigned char>({0xf9, 0x7c, 0x00}));
+		assert(number_cbor("1e-400") == std::vector<unsigned char>({0xf9, 0x00, 0x00}));
+		assert(number_cbor("-1e-400") == std::vector<unsigned char>({0xf9, 0x80, 0x00}));
+	}
+	
+	{ // tag handlers
+		auto decode_hex = [](std::vector<uint8_t> bytes, auto& value) {
+			cbor::Input input(bytes.data(), (int)bytes.size());
+			cbor::decode(input, value);
+			assert(input.is_empty());
+		};
+		cbor::TimePoint time;
+		decode_hex({0xc1, 0x1a, 0x51, 0x4b, 0x67, 0xb0}, time);
+		assert(time.time_since_epoch() == std::chrono::seconds(1363896240));
+		decode_hex({0xc1, 0xfb, 0x41, 0xd4, 0x52, 0xd9, 0xec, 0x20, 0x00, 0x00}, time);
+		assert(time.time_since_epoch() == std::chrono::milliseconds(1363896240500));
+		__int128 big;
+		decode_hex({0xc2, 0x49, 0x01, 0, 0, 0, 0, 0, 0, 0, 0}, big);
+		assert(big == (__int128)1 << 64);
+		decode_hex({0xc3, 0x49, 0x01, 0, 0, 0, 0, 0, 0, 0, 0}, big);
+		assert(big == -((__int128)1 << 64) - 1);
+		cbor::DecimalFraction fraction;
+		decode_hex({0xc4, 0x82, 0x21, 0x19, 0x6a, 0xb3}, fraction);
+		assert(fraction.exponent == -2 && fraction.mantissa == 27315);
+		std::variant<cbor::Uuid, cbor::TimePoint> either;
+		decode_hex({0xc1, 0x00}, either);
+		assert(std::get<cbor::TimePoint>(either).time_since_epoch().count() == 0);
+		
+		Payment payment{cbor::TimePoint(std::chrono::milliseconds(1700000000250)), {-2, 1999}, {}, -((__int128)1 << 100), {}};
+		payment.id.bytes[0] = 0xf8;
+		payment.settled = cbor::TimePoint(std::chrono::seconds(1700000100));
+		cbor::OutputDynamic output;
+		cbor::encode(output, payment);
+		cbor::Input input(output.data(), output.size());
+		auto decoded = cbor::decode<Payment>(input);
+		assert(decoded.time == payment.time && decoded.settled == payment.settled);
+		assert(decoded.amount.exponent == -2 && decoded.amount.mantissa == 1999);
+		assert(decoded.id.bytes == payment.id.bytes && decoded.balance == payment.balance);
+		
+		bool thrown = false;
+		try {
+			decode_hex({0xc2, 0x51, 0x01, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, big);
+		} catch(cbor::DecodeException const&) {
+			thrown = true;
+		}
+		assert(thrown);
+	}
+	
+	{ // typed decoding of hostile lengths
+		auto rejects = [](std::vector<uint8_t> bytes, auto value) {
+			cbor::Input input(bytes.data(), (int)bytes.size());
+			try {
+				cbor::decode(input, value);
+			} catch(cbor::DecodeException const&) {
+				return true;
+			}
+			return false;
+		};
+		assert(rejects({0x5b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff}, std::vector<char>()));
+		assert(rejects({0x9b, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x01}, std::vector<int32_t>()));
+		assert(rejects({0xbb, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00}, std::unordered_map<std::string, int32_t>()));
+		assert(rejects({0xc2, 0x5b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff}, (__int128)0));
+		assert(rejects({0xc2, 0x5a, 0x7f, 0xff, 0xff, 0xff, 0x00}, (__int128)0));
+		
+		// an unknown field nested far deeper than the stack would allow recursion
+		std::vector<uint8_t> deep = {0xa2, 0x61, 'x', 0x81};
+		deep.insert(deep.end(), 1000000, 0x81);
+		deep.insert(deep.end(), {0x00, 0x64, 'c', 'i', 't', 'y', 0x61, 'a'});
+		cbor::Input input(deep.data(), (int)deep.size());
+		auto address = cbor::decode<Address>(input);
+		assert(input.is_empty() && address.city == "a");
+	}
+	
+	{ // segmented output on a non-blocking fd
+		std::vector<uint8_t> payload(300000);
+		for(size_t i = 0; i < payload.size(); ++i) {
+			payload[i] = (uint8_t)(i * 7);
+		}
+		cbor::OutputSegmented output(4096, 1024);
+		cbor::Encoder(output).write_bytes_ref(payload.data(), (uint32_t)payload.size());
+		auto expected = output.bytes();
+		
+		int fds[2];
+		assert(pipe(fds) == 0);
+		fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+		std::vector<uint8_t> received;
+		uint8_t chunk[65536];
+		bool would_block = false;
+		while(!output.flush_to_fd(fds[1])) {
+			would_block = true;
+			auto count = read(fds[0], chunk, sizeof(chunk));
+			assert(count > 0);
+			received.insert(received.end(), chunk, chunk + count);
+		}
+		close(fds[1]);
+		for(ssize_t count; (count = read(fds[0], chunk, sizeof(chunk))) > 0;) {
+			received.insert(received.end(), chunk, chunk + count);
+		}
+		close(fds[0]);
+		assert(would_block && output.size() == 0);
+		assert(received.size() == expected.size() && std::equal(received.begin(), received.end(), expected.begin()));
+	}
+	
+	{ // framed output on a non-blocking socket
+		cbor::FrameWriter writer(true, SIZE_MAX);
+		cbor::Encoder encoder(writer);
+		for(int i = 0; i < 100; ++i) {
+			writer.begin_frame();
+			encoder.write_array(2);
+			encoder.write_int(i);
+			encoder.write_string(std::string(4000, (char)('a' + i % 26)));
+			writer.end_frame();
+		}
+		
+		int fds[2];
+		assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+		fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+		std::vector<uint8_t> received;
+		uint8_t chunk[65536];
+		bool would_block = false;
+		while(!writer.flush_to_fd(fds[0])) {
+			would_block = true;
+			auto count = read(fds[1], chunk, sizeof(chunk));
+			assert(count > 0);
+			received.insert(received.end(), chunk, chunk + count);
+		}
+		close(fds[0]);
+		for(ssize_t count; (count = read(fds[1], chunk, sizeof(chunk))) > 0;) {
+			received.insert(received.end(), chunk, chunk + count);
+		}
+		close(fds[1]);
+		assert(would_block && writer.size() == 0 && writer.frame_count() == 0);
+		
+		// a resent prefix would break the framing or the checksums
+		cbor::FrameSplitter splitter;
+		splitter.feed(received.data(), received.size());
+		cbor::Frame frame;
+		int count = 0;
+		while(splitter.next(frame)) {
+			cbor::Input input((void*)frame.data, (int)frame.size);
+			auto result = cbor::Decoder(input).run();
+			assert(result->as_array()[0]->as_int() == count);
+			++count;
+		}
+		assert(count == 100);
+	}
+	
+	{ // ring buffer capacity checks
+		auto error = [](auto make) -> std::string {
+			try {
+				make();
+			} catch(cbor::Exception const& exception) {
+				return exception.what();
+			}
+			return "";
+		};
+		alignas(64) uint8_t memory[256];
+		assert(error([&] { cbor::RingBuffer::create(memory, 0); }) == "ring buffer capacity has to be a power of two");
+		assert(error([&] { cbor::RingBuffer::create(memory, 96); }) == "ring buffer capacity has to be a power of two");
+		assert(error([&] { cbor::RingBuffer::create(memory, (size_t)1 << 31); }) == "ring buffer capacity is too large");
+		
+		// a zeroed segment, as seen before the creator initialized it
+		std::string name = "/cbor_cpp_tests_ring_" + std::to_string(getpid());
+		auto fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+		assert(fd >= 0 && ftruncate(fd, (off_t)cbor::RingBuffer::required_size(64)) == 0);
+		close(fd);
+		assert(error([&] { cbor::RingBuffer::open_shared(name); }) == "shared ring buffer is not initialized");
+		cbor::RingBuffer::remove_shared(name);
+	}
+	
+	{ // parallel decoding of deeply nested items
+		std::vector<uint8_t> deep = {0x82, 0x01};
+		deep.insert(deep.end(), 1000000, 0x81);
+		deep.push_back(0x02);
+		auto result = cbor::decode_parallel(deep.data(), deep.size(), 2, 1);
+		assert(result->as_array().size() == 2 && result->as_array()[0]->as_int() == 1);
+	}
+	
+	{ // write_object and the resumable encoder agree
+		auto inner = cbor::Object::create_map(3);
+		auto& inner_map = inner->as<cbor::ObjectType::Map>();
+		inner_map["bbb"] = cbor::Object::from_int(-300);
+		inner_map["a"] = cbor::Object::create_array(0);
+		inner_map["cc"] = cbor::Object::from_bytes({'x', 'y'});
+		auto root = cbor::Object::create_map(2);
+		auto& root_map = root->as<cbor::ObjectType::Map>();
+		root_map["long key"] = inner;
+		root_map["k"] = cbor::Object::create_array(2);
+		root_map["k"]->as<cbor::ObjectType::Array>().push_back(inner);
+		root_map["k"]->as<cbor::ObjectType::Array>().push_back(cbor::Object::from_string("s"));
+		
+		for(auto deterministic: {false, true}) {
+			cbor::OutputDynamic direct;
+			cbor::Encoder encoder(direct);
+			encoder.set_deterministic(deterministic);
+			// the stack of the encoder is reused by the second call
+			encoder.write_object(root);
+			encoder.write_object(root);
+			cbor::OutputDynamic resumable;
+			for(int i = 0; i < 2; ++i) {
+				cbor::ResumableEncoder(root, deterministic).encode_some(resumable, SIZE_MAX);
+			}
+			assert(direct.size() == resumable.size() && memcmp(direct.data(), resumable.data(), direct.size()) == 0);
+		}
+		
+		// payloads are copied, so the output does not depend on the tree staying alive
+		cbor::OutputSegmented segmented(4096, 1024);
+		{
+			auto large = cbor::Object::create_array(2);
+			large->as<cbor::ObjectType::Array>().push_back(cbor::Object::from_string(std::string(8192, 's')));
+			large->as<cbor::ObjectType::Array>().push_back(cbor::Object::from_bytes(cbor::BytesValue(8192, 'b')));
+			cbor::Encoder(segmented).write_object(large);
+		}
+		auto copied = segmented.bytes();
+		assert(copied.size() == 1 + 2 * (3 + 8192) && copied[4] == 's' && copied.back() == 'b');
+	}
+	
+	{ // interned decoding of invalid keys
+		uint8_t container_key[] = {0xa1, 0x81, 0x01, 0x02};
+		cbor::ObjectInterner interner;
+		cbor::Input input(container_key, sizeof(container_key));
+		cbor::Decoder decoder(input);
+		decoder.set_interner(interner);
+		bool thrown = false;
+		try {
+			decoder.run();
+		} catch(cbor::DecodeException const&) {
+			thrown = true;
+		}
+		assert(thrown);
+		
+		// interned trees share nodes, which the encode cache refuses
+		uint8_t shared[] = {0x82, 0x81, 0x01, 0x81, 0x01};
+		cbor::Input shared_input(shared, sizeof(shared));
+		cbor::Decoder shared_decoder(shared_input);
+		shared_decoder.set_interner(interner);
+		auto root = shared_decoder.run();
+		assert(root->as_array()[0] == root->as_array()[1]);
+		cbor::EncodeCache cache;
+		cbor::OutputDynamic output;
+		thrown = false;
+		try {
+			cache.encode(output, root);
+		} catch(cbor::EncodeException const&) {
+			thrown = true;
+		}
+		assert(thrown);
+	}
+	
+	{ // exception rethrow and out of memory errors
+		std::shared_ptr<cbor::Exception> copy = cbor::DecodeException("copied").dynamic_copy_exception();
+		bool rethrown = false;
+		try {
+			copy->dynamic_rethrow_exception();
+		} catch(cbor::DecodeException const& exception) {
+			rethrown = std::string(exception.what()) == "copied";
+		}
+		assert(rethrown);
+		rethrown = false;
+		try {
+			cbor::Exception(7, "Custom", "custom").dynamic_rethrow_exception();
+		} catch(cbor::Exception const& exception) {
+			rethrown = exception.code() == 7;
+		}
+		assert(rethrown);
+		assert(std::string(cbor::error_message(cbor::ErrorCode::OutOfMemory)) == "out of memory");
+	}
+	
+	{ // decode limits with only a depth limit
+		uint8_t huge_array[] = {0x9a, 0x7f, 0xff, 0xff, 0xff};
+		cbor::DecodeLimits limits;
+		limits.max_depth = 8;
+		cbor::Input input(huge_array, sizeof(huge_array));
+		cbor::Decoder decoder(input);
+		decoder.set_limits(limits);
+		bool thrown = false;
+		try {
+			decoder.run();
+		} catch(cbor::DecodeException const&) {
+			thrown = true;
+		}
+		assert(thrown);
+	}
+	
+	{ // hashing deeply nested trees
+		auto make = [](cbor::IntValue leaf) {
+			auto root = cbor::Object::create_array(1);
+			auto node = root;
+			for(int i = 0; i < 1000000; ++i) {
+				auto child = i % 2 == 0 ? cbor::Object::create_array(1) : cbor::Object::create_map(1);
+				if(node->is_array()) {
+					node->as<cbor::ObjectType::Array>().push_back(child);
+				} else {
+					node->as<cbor::ObjectType::Map>()["k"] = child;
+				}
+				node = child;
+			}
+			node->as<cbor::ObjectType::Map>()["k"] = cbor::Object::from_int(leaf);
+			return root;
+		};
+		auto first = make(1);
+		auto second = make(1);
+		auto other = make(2);
+		assert(cbor::equal(*first, *second) && !cbor::equal(*first, *other));
+		assert(cbor::hash(*first) == cbor::hash(*second) && cbor::hash(*first) != cbor::hash(*other));
+		
+		cbor::OutputDynamic output;
+		cbor::Encoder(output).write_object(first);
+		uint64_t encoded = 0;
+		assert(!cbor::hash_encoded(output.data(), output.size(), encoded) && encoded == cbor::hash(*first));
+		
+		cbor::HashCache cache;
+		assert(cache.hash(first) == encoded && cache.size() == 1000001);
+		assert(cache.hash(first->as_array()[0]) != encoded && cache.size() == 1000001);
+		assert(first->memory_usage() > 1000000 * sizeof(cbor::Object));
+		
+		// the non-throwing encoder measures the tree first
+		assert(cbor::encoded_size(first) == output.size());
+		cbor::OutputDynamic checked;
+		assert(!cbor::try_encode(checked, first) && checked.size() == output.size());
+		assert(memcmp(checked.data(), output.data(), output.size()) == 0);
+	}
+	
+	{ // tags as prefixes of their items
+		const uint8_t tagged[] = {0x81, 0xc1, 0x05};
+		cbor::PObject result;
+		assert(!cbor::try_decode(tagged, sizeof(tagged), result));
+		auto const& tag = result->as_array().at(0);
+		assert(result->as_array().size() == 1 && tag->as_tag().tag == 1 && tag->tagged_item()->as_int() == 5);
+		uint64_t encoded_hash = 0;
+		assert(!cbor::hash_encoded(tagged, sizeof(tagged), encoded_hash) && encoded_hash == cbor::hash(*result));
+		cbor::OutputDynamic json;
+		assert(!cbor::cbor_to_json(tagged, sizeof(tagged), json));
+		assert(std::string((const char*)json.data(), json.size()) == "[5]");
+		cbor::OutputDynamic reencoded;
+		cbor::Encoder(reencoded).write_object(result);
+		assert(reencoded.bytes() == std::vector<unsigned char>(tagged, tagged + sizeof(tagged)));
+		assert(!cbor::equal(*result, *cbor::Object::from_int(5)) && cbor::hash(*tag) != cbor::hash(*tag->tagged_item()));
+		
+		// nested tags, a 64-bit tag number and a tagged map value
+		const uint8_t nested[] = {0xa1, 0x61, 't', 0xc1, 0xdb, 0, 0, 0, 1, 0, 0, 0, 0, 0x82, 0x01, 0xc2, 0x41, 0x00};
+		assert(!cbor::try_decode(nested, sizeof(nested), result));
+		auto const& outer = result->as_map().at("t");
+		auto const& inner = outer->tagged_item();
+		assert(outer->tag_number() == 1 && inner->object_type() == cbor::ObjectType::ExtraTag && inner->tag_number() == 1ull << 32);
+		assert(inner->tagged_item()->as_array().size() == 2 && inner->tagged_item()->as_array()[1]->tag_number() == 2);
+		assert(!cbor::hash_encoded(nested, sizeof(nested), encoded_hash) && encoded_hash == cbor::hash(*result));
+		cbor::OutputDynamic nested_output;
+		cbor::Encoder(nested_output).write_object(result);
+		assert(nested_output.bytes() == std::vector<unsigned char>(nested, nested + sizeof(nested)));
+		assert(cbor::encoded_size(result) == sizeof(nested));
+		cbor::OutputDynamic resumable;
+		cbor::ResumableEncoder(result).encode_some(resumable, SIZE_MAX);
+		assert(resumable.bytes() == nested_output.bytes());
+		cbor::ObjectInterner interner;
+		cbor::Input interned_input((void*)nested, (int)sizeof(nested));
+		cbor::Decoder interned_decoder(interned_input);
+		interned_decoder.set_interner(interner);
+		assert(cbor::equal(*interned_decoder.run(), *result));
+		
+		const uint8_t tagged_key[] = {0xa1, 0xc1, 0x61, 't', 0x01};
+		assert(cbor::try_decode(tagged_key, sizeof(tagged_key), result).code == cbor::ErrorCode::InvalidMapKey);
+		const uint8_t dangling[] = {0x81, 0xc1};
+		assert(cbor::try_decode(dangling, sizeof(dangling), result).code == cbor::ErrorCode::UnexpectedEnd);
+		assert(cbor::hash_encoded(dangling, sizeof(dangling), encoded_hash).code == cbor::ErrorCode::UnexpectedEnd);
+		
+		// the parallel decoder splits between items, the tags stay with theirs
+		cbor::OutputDynamic items;
+		cbor::Encoder items_encoder(items);
+		items_encoder.write_array(64);
+		for(int i = 0; i < 64; ++i) {
+			items_encoder.write_tag(i);
+			items_encoder.write_int(i);
+		}
+		auto parallel = cbor::decode_parallel(items.data(), items.size(), 4, 4);
+		assert(parallel->as_array().size() == 64 && parallel->as_array()[63]->tagged_item()->as_int() == 63);
+		
+		// tags nest like containers, so chains of them are bounded by the depth limit and handled without recursion
+		std::vector<uint8_t> chain(1000000, 0xc1);
+		chain.push_back(0x00);
+		cbor::DecodeLimits limits;
+		limits.max_depth = 64;
+		assert(cbor::try_decode(chain.data(), chain.size(), result, limits).code == cbor::ErrorCode::LimitExceeded);
+		assert(!cbor::try_decode(chain.data(), chain.size(), result));
+		assert(!cbor::hash_encoded(chain.data(), chain.size(), encoded_hash) && encoded_hash == cbor::hash(*result));
+		cbor::OutputDynamic chain_output;
+		cbor::Encoder(chain_output).write_object(result);
+		assert(chain_output.bytes() == chain && !cbor::equal(*result, *result->tagged_item()));
+	}
+	
+	{ // tag handlers in the tree decoder
+		cbor::TagRegistry registry;
+		registry.add<cbor::TimePoint>();
+		registry.add<__int128>();
+		registry.add<cbor::Uuid>();
+		cbor::Uuid id{};
+		for(size_t i = 0; i < id.bytes.size(); ++i) {
+			id.bytes[i] = (uint8_t)i;
+		}
+		// keys in sorted order, so the tree writes the document back unchanged
+		cbor::OutputDynamic document;
+		cbor::Encoder writer(document);
+		writer.write_map(4);
+		writer.write_string("d");
+		cbor::TagHandler<cbor::DecimalFraction>::encode(writer, {-2, 1999});
+		writer.write_string("id");
+		cbor::TagHandler<cbor::Uuid>::encode(writer, id);
+		writer.write_string("n");
+		cbor::TagHandler<__int128>::encode(writer, -((__int128)1 << 100));
+		writer.write_string("t");
+		cbor::TagHandler<cbor::TimePoint>::encode(writer, cbor::TimePoint(std::chrono::seconds(1700000000)));
+		
+		cbor::Input input(document.data(), (int)document.size());
+		cbor::Decoder decoder(input);
+		decoder.set_tag_registry(registry);
+		auto result = decoder.run();
+		auto const& map_value = result->as_map();
+		assert(cbor::native_value<cbor::TimePoint>(*map_value.at("t"))->time_since_epoch() == std::chrono::seconds(1700000000));
+		assert(*cbor::native_value<__int128>(*map_value.at("n")) == -((__int128)1 << 100));
+		assert(cbor::native_value<cbor::Uuid>(*map_value.at("id"))->bytes == id.bytes);
+		assert(cbor::native_value<cbor::Uuid>(*map_value.at("t")) == nullptr);
+		// tag 4 has no handler in the registry and stays a prefix node
+		auto const& fraction = map_value.at("d");
+		assert(fraction->tag_number() == 4 && fraction->tagged_item()->as_array().size() == 2);
+		
+		cbor::OutputDynamic reencoded;
+		cbor::Encoder(reencoded).write_object(result);
+		assert(reencoded.bytes() == document.bytes());
+		assert(cbor::encoded_size(result) == document.size());
+		cbor::OutputDynamic resumable;
+		cbor::ResumableEncoder resumable_encoder(result);
+		while(!resumable_encoder.done()) {
+			resumable_encoder.encode_some(resumable, 3);
+		}
+		assert(resumable.bytes() == document.bytes());
+		uint64_t encoded_hash = 0;
+		assert(!cbor::hash_encoded(document.data(), document.size(), encoded_hash) && encoded_hash == cbor::hash(*result));
+		cbor::Input plain_input(document.data(), (int)document.size());
+		auto plain = cbor::Decoder(plain_input).run();
+		assert(cbor::hash(*plain) == cbor::hash(*result) && !cbor::equal(*plain, *result));
+		cbor::Input again_input(document.data(), (int)document.size());
+		cbor::Decoder again_decoder(again_input);
+		again_decoder.set_tag_registry(registry);
+		assert(cbor::equal(*again_decoder.run(), *result));
+		
+		const uint8_t truncated[] = {0x81, 0xc1, 0x1a, 0x00};
+		cbor::Input truncated_input((void*)truncated, (int)sizeof(truncated));
+		cbor::Decoder truncated_decoder(truncated_input);
+		truncated_decoder.set_tag_registry(registry);
+		auto thrown = false;
+		try {
+			truncated_decoder.run();
+		} catch(cbor::DecodeException const&) {
+			thrown = true;
+		}
+		assert(thrown);
 	}
 	
 	return 0;